@@ -0,0 +1,163 @@
+/**
+ A single deck of cards, or a shoe of several decks. The cards are always
+ in the fixed order saved in the "cards" array in the "rank suit" format.
+ The cards are drawn from the deck in the order of the "order" array,
+ where we move the "pointer" pointing at given card in "order". The
+ "order" array holds the index of each card of each deck in "cards", and
+ can be shuffled.
+ Returning discarded cards to the deck can be done by setting "pointer"
+ back to zero and calling "shuffle()" to the deck, which is wrapped into
+ "reset()" method.
+ 
+ Unless the deck is seeded, each shuffle uses a random engine seeded by
+ the clock. A seeded deck draws all of its shuffles from its own random
+ engine, so that the same seed gives the same sequence of shuffles.
+ 
+ Instead of shuffling, the deck can take its cards from the shoes of a
+ shoe bank (see ShoeBank.h), one shoe at every reset, in the order of the
+ bank; it then plays the same cards whenever it is given the same shoes.
+ The shoes of the bank must hold at least as many cards as the deck.
+ 
+ It is in the Common directory, included by both the Evolve_strategy and
+ Test_strategy modules.
+ */
+
+using namespace std;
+
+class Deck{
+public:
+    // Constructor takes the number of decks, one by default.
+    Deck(int decks=1);
+    
+    // Shuffle the "order" array.
+    void Shuffle();
+    
+    // Set the pointer to zero and shuffle.
+    void reset();
+    
+    // Seed the random engine used for all following shuffles, put the
+    // cards back into their fixed order, and reset.
+    void seed(const unsigned &);
+    
+    // Take the cards from the given number of shoes of the given number of
+    // cards, which follow one another in memory (see ShoeBank::shoes()),
+    // starting with the first of them, and reset. The memory must outlive
+    // the deck; nullptr, or shoes smaller than the deck, go back to
+    // shuffling.
+    void use_bank(const unsigned char *, const int &, const unsigned long long &);
+    
+    // Pick a number from the "order" array to which the "pointer"
+    // points and increment the pointer by one.
+    int deal_card();
+    
+    // The "rank suit" from the "cards" array with the given index.
+    string show_card(const int & );
+    
+    // The "rank" from the "cards" array with the given index.
+    // Returns 'A' or '2'-'9' or 'T', assuming 'J'='K'='Q'='T'.
+    char show_rank(const int & );
+    
+    // Interface to the private variables:
+    vector<string> get_cards(){
+        return cards;
+    }
+    const vector<int> & get_order(){
+        return order;
+    }
+    int get_pointer(){
+        return pointer;
+    }
+private:
+    vector<string> cards;
+    vector<int> order;
+    int pointer;
+    // Random engine for the shuffles, used only if the deck is seeded.
+    default_random_engine engine;
+    bool seeded;
+    // Shoes of the shoe bank, if the deck uses one, the cards per shoe,
+    // the number of shoes, and the shoe to be taken next.
+    const unsigned char * bank;
+    int bank_cards;
+    unsigned long long bank_count;
+    unsigned long long bank_next;
+};
+
+Deck::Deck(int decks){
+    cards={};
+    order=vector<int>(52*max(1,decks));
+    for(int i=0;i<order.size();++i)
+        order[i]=i%52;
+    // hearts, diamonds, spades, clubs.
+    vector<char> suits={'H','D','S','C'};
+    vector<char> ranks={'2','3','4','5','6','7',
+        '8','9','T','J','Q','K','A'};
+    for(auto rank : ranks){
+        for(auto suit : suits){
+            string card="";
+            card+=rank;
+            card+=" ";
+            card+=suit;
+            cards.push_back(card);
+        }
+    }
+    pointer=0;
+    seeded=false;
+    bank=nullptr;
+}
+
+void Deck::Shuffle(){
+    if(bank!=nullptr){
+        // Only the first cards of a larger shoe are played.
+        const unsigned char * shoe=bank+bank_next*bank_cards;
+        for(int i=0;i<order.size();++i)
+            order[i]=shoe[i];
+        bank_next=(bank_next+1)%bank_count;
+        return;
+    }
+    if(seeded){
+        shuffle(order.begin(), order.end(), engine);
+        return;
+    }
+    unsigned seed =chrono::system_clock::now().time_since_epoch().count();
+    shuffle(order.begin(), order.end(), default_random_engine(seed));
+}
+
+void Deck::reset(){
+    pointer=0;
+    Shuffle();
+}
+
+void Deck::seed(const unsigned & s){
+    engine.seed(s);
+    seeded=true;
+    // Shuffles permute the current order, so start from the fixed one.
+    for(int i=0;i<order.size();++i)
+        order[i]=i%52;
+    reset();
+}
+
+void Deck::use_bank(const unsigned char * shoes, const int & cards,
+                    const unsigned long long & count){
+    bank=(cards>=order.size()) ? shoes : nullptr;
+    bank_cards=cards;
+    bank_count=max(1ULL,count);
+    bank_next=0;
+    reset();
+}
+
+int Deck::deal_card(){
+    int a=order[pointer++];
+    return a;
+}
+
+string Deck::show_card(const int & index){
+    string card=cards[index];
+    return card;
+}
+
+char Deck::show_rank(const int & index){
+    char rank=cards[index][0];
+    if(rank=='J'||rank=='Q'||rank=='K')
+        rank='T';
+    return rank;
+}
@@ -0,0 +1,662 @@
+/**
+
+ GameEngine is the blackjack game of both modules: the Game of the
+ Evolve_strategy module and the Game of the Test_strategy module are both
+ a GameEngine (see their Game.h), and so are the games of the other rules
+ of RulesRegistry.h. It is in the Common directory, included by both the
+ Evolve_strategy and Test_strategy modules.
+
+ GameEngine inherits the Deck, and plays the one-player game against the
+ dealer for the player following the strategy it inherits from its first
+ template parameter. The strategy is any class with the decisions
+
+ * bool split_pair(rank of the pair, dealer's upcard),
+ * bool soft_double_down(player's hand, dealer's upcard),
+ * bool hard_double_down(player's hand, dealer's upcard),
+ * bool hard_stand(cards in the hand, count, dealer's upcard, first
+   card, second card),
+ * bool soft_stand(count, dealer's upcard),
+
+ with a default constructor and a constructor taking the 800 genes, as
+ the Chromosome of the Evolve_strategy module and the BasicStrategy of the
+ Test_strategy module. The decisions are called directly, not through
+ virtual functions, so the compiler inlines them into the game.
+
+ The second template parameter is the house rules, one of the policies of
+ Rules.h. With RulesS17 the game is played with a single deck, dealer
+ stands on soft 17. Cannot double down on split aces. Split aces receive
+ up to 3 cards in total per hand. Split hands cannot be split again.
+ Natural pays 3:2, split two-card 21 is not natural.
+
+ The third template parameter is the statistics policy, which picks the
+ groups of statistics the game keeps besides the bankrolls, the wins and
+ the rounds played, each group on its own:
+
+ * outcomes, the number of draws,
+ * breakdown, the number of double downs and splits and how many of
+   their hands were won and lost,
+ * bankroll path, the time series of the player's bankroll after each
+   hand,
+ * cell visits, how many times each of the 800 genes of the strategy was
+   looked up for a decision, in the order of the genes of the chromosome.
+
+ The policy is known at compile time, so a group which is not kept
+ compiles to nothing and the game doesn't pay anything for it:
+ NoStatistics, all the evolution needs, plays the same code as a game
+ without any statistics at all.
+
+ */
+
+using namespace std;
+
+// Statistics policy of GameEngine, whether each group of statistics is
+// kept.
+template<bool Outcomes, bool Breakdown, bool BankrollPath, bool CellVisits>
+struct StatisticsGroups{
+    static constexpr bool outcomes=Outcomes;
+    static constexpr bool breakdown=Breakdown;
+    static constexpr bool bankroll_path=BankrollPath;
+    static constexpr bool cell_visits=CellVisits;
+};
+
+// No statistics, for the evolution.
+typedef StatisticsGroups<false,false,false,false> NoStatistics;
+// The statistics the game of the Test_strategy module has always kept.
+typedef StatisticsGroups<true,true,true,false> GameStatistics;
+// All statistics.
+typedef StatisticsGroups<true,true,true,true> AllStatistics;
+
+template<class Strategy, class Rules=RulesS17, class Statistics=NoStatistics>
+class GameEngine : public Deck, public Strategy{
+public:
+    // Default constructor, give the starting bankroll
+    // to the player and the dealer, and the fixed bet size.
+    // The strategy is made by its default constructor.
+    GameEngine(int, int, int);
+    // Constructor for the given chromosome vector, passed to the strategy.
+    GameEngine(int, int, int, vector<int>);
+    // One round, played until either player or dealer wins/busts.
+    void one_round();
+    // One round when player has split given rank.
+    void split_round(const char &);
+    // Clear the variables for the next round.
+    void clear_for_next_round();
+    // Play the specified number of rounds. The game stops when the player
+    // or the dealer goes bankrupt, and then the count of the player's wins
+    // is set to zero, to kill the strategies which make the player go
+    // bankrupt in the genetic selection.
+    void play(const int &);
+    // Play the specified number of rounds, keeping the count of the wins
+    // of the player who went bankrupt. The other two numbers are not used
+    // any more.
+    void play(const int &, const int &, const int &);
+
+    // Set player's bankroll.
+    void set_player_bankroll(const int & P){
+        player_bankroll=P;
+        return;
+    }
+    // Set dealer's bankroll.
+    void set_dealer_bankroll(const int & D){
+        dealer_bankroll=D;
+        return;
+    }
+    // Interfaces to the private variables
+    int get_player_bankroll(){
+        return player_bankroll;
+    }
+    int get_dealer_bankroll(){
+        return dealer_bankroll;
+    }
+    int get_bet_size(){
+        return bet_size;
+    }
+    // Most bets a round can cost under the rules of the game.
+    static int get_max_bets(){
+        return max_bets<Rules>();
+    }
+    bool get_player_soft(){
+        return player_soft;
+    }
+    bool get_dealer_soft(){
+        return dealer_soft;
+    }
+    int get_player_count(){
+        return player_count;
+    }
+    int get_dealer_count(){
+        return dealer_count;
+    }
+    bool get_player_doubled_down(){
+        return player_doubled_down;
+    }
+    bool get_player_pair(){
+        return player_pair;
+    }
+    bool get_player_natural(){
+        return player_natural;
+    }
+    bool get_dealer_natural(){
+        return dealer_natural;
+    }
+    bool get_player_busted(){
+        return player_busted;
+    }
+    bool get_dealer_busted(){
+        return dealer_busted;
+    }
+    bool get_player_split(){
+        return split;
+    }
+    int get_player_won(){
+        return player_won;
+    }
+    int get_rounds_played(){
+        return rounds_played;
+    }
+    vector<char> get_player_hand(){
+        return player_hand;
+    }
+    vector<char> get_dealer_hand(){
+        return dealer_hand;
+    }
+    // Statistics, zero (or empty) for the groups which are not kept.
+    int get_draws(){
+        return draws;
+    }
+    int get_times_player_doubled_down(){
+        return times_player_doubled_down;
+    }
+    int get_times_player_doubled_down_and_won(){
+        return times_player_doubled_down_and_won;
+    }
+    int get_times_player_doubled_down_and_lost(){
+        return times_player_doubled_down_and_lost;
+    }
+    int get_times_player_split(){
+        return times_player_split;
+    }
+    int get_times_player_split_and_won(){
+        return times_player_split_and_won;
+    }
+    int get_times_player_split_and_lost(){
+        return times_player_split_and_lost;
+    }
+    vector<int> get_player_time_series(){
+        return player_time_series;
+    }
+    vector<long long> get_cell_visits(){
+        return cell_visits;
+    }
+private:
+    int player_bankroll;
+    int dealer_bankroll;
+    int bet_size;
+    // Whether player or dealer has a soft hand.
+    bool player_soft;
+    bool dealer_soft;
+    // Counts of the totals for player and dealer hands.
+    // If player or dealer has a soft hand then it's a soft count.
+    // It will be automatically re-calculated as a hard count if the
+    // hand becomes hard.
+    int player_count;
+    int dealer_count;
+    // If player has doubled down.
+    bool player_doubled_down;
+    // If player has a pair.
+    bool player_pair;
+    // If player or dealer has a natural.
+    bool player_natural;
+    bool dealer_natural;
+    // If the player or dealer has busted.
+    bool player_busted;
+    bool dealer_busted;
+    // How many times player won, and how many rounds have been played.
+    int player_won;
+    int rounds_played;
+    // Hands of player and dealer.
+    vector<char> player_hand;
+    vector<char> dealer_hand;
+    // States of the player's and the dealer's hands (see HandState.h).
+    int player_state;
+    int dealer_state;
+    // If player splits.
+    bool split;
+    // Number of hands the pair has been split into.
+    int split_hands;
+    // Statistics: how many times the result was a draw, how many times
+    // player has doubled down or split and how many of these it won or
+    // lost, the player's bankroll after each hand, and how many times
+    // each gene was looked up.
+    int draws;
+    int times_player_doubled_down;
+    int times_player_doubled_down_and_won;
+    int times_player_doubled_down_and_lost;
+    int times_player_split;
+    int times_player_split_and_won;
+    int times_player_split_and_lost;
+    vector<int> player_time_series;
+    vector<long long> cell_visits;
+    // Initialize the variables of the game, for the constructors.
+    void start(int, int, int);
+    // Add the card of the given rank to the hand in the given state, and
+    // set the count and the softness of the hand from its new state.
+    void add_card(int &, int &, bool &, const char &);
+    // Set the hand to the given state, with its count and softness.
+    void set_state(int &, int &, bool &, const int &);
+    // Hit the dealer until 17 or higher (and on soft 17 if the dealer
+    // hits soft 17).
+    void play_dealer();
+    // The decisions of the strategy for the player's hand against the
+    // dealer's upcard, counting the visit of the gene looked up if the
+    // cell visits are kept.
+    bool ask_split_pair(const char &);
+    bool ask_soft_double_down();
+    bool ask_hard_double_down();
+    bool ask_hard_stand();
+    bool ask_soft_stand();
+    // Count the visit of the gene of the given matrix of the chromosome,
+    // starting at the given gene, for the given row and the dealer's upcard.
+    void visit(const int &, const int &);
+    // Settle the player's hand: 1 if the player won, 0 for a draw, -1 if
+    // the player lost. The bet is doubled if the player doubled down.
+    void settle(const int &);
+    // Play the rounds, true if stopped by a bankruptcy.
+    bool play_rounds(const int &);
+};
+
+template<class Strategy, class Rules, class Statistics>
+GameEngine<Strategy,Rules,Statistics>::GameEngine(int p, int d, int b) :
+    Deck(Rules::decks){
+    start(p,d,b);
+}
+
+template<class Strategy, class Rules, class Statistics>
+GameEngine<Strategy,Rules,Statistics>::GameEngine(int p, int d, int b, vector<int> chrom) :
+    Deck(Rules::decks), Strategy(chrom){
+    start(p,d,b);
+}
+
+template<class Strategy, class Rules, class Statistics>
+void GameEngine<Strategy,Rules,Statistics>::start(int p, int d, int b){
+    player_bankroll=p;
+    dealer_bankroll=d;
+    bet_size=b;
+    // Default state of each hand is hard, the player/dealer have soft
+    // hand if exactly one card is ace without the total going over 21.
+    player_soft=false;
+    dealer_soft=false;
+    player_count=0;
+    dealer_count=0;
+    player_doubled_down=false;
+    player_pair=false;
+    player_natural=false;
+    dealer_natural=false;
+    player_busted=false;
+    dealer_busted=false;
+    player_won=0;
+    rounds_played=0;
+    player_state=HAND_EMPTY;
+    dealer_state=HAND_EMPTY;
+    split=false;
+    split_hands=0;
+    draws=0;
+    times_player_doubled_down=0;
+    times_player_doubled_down_and_won=0;
+    times_player_doubled_down_and_lost=0;
+    times_player_split=0;
+    times_player_split_and_won=0;
+    times_player_split_and_lost=0;
+    player_time_series={};
+    cell_visits=vector<long long>(Statistics::cell_visits ? 800 : 0,0);
+    // Reset the deck at the beginning of the game.
+    reset();
+}
+
+template<class Strategy, class Rules, class Statistics>
+void GameEngine<Strategy,Rules,Statistics>::set_state(int & state, int & count, bool & soft,
+                                                      const int & s){
+    state=s;
+    count=hand_total[state];
+    soft=hand_soft[state];
+}
+
+template<class Strategy, class Rules, class Statistics>
+void GameEngine<Strategy,Rules,Statistics>::add_card(int & state, int & count, bool & soft,
+                                                     const char & rank){
+    set_state(state,count,soft,hand_next[state][hand_rank(rank)]);
+}
+
+template<class Strategy, class Rules, class Statistics>
+void GameEngine<Strategy,Rules,Statistics>::play_dealer(){
+    // Dealer stops if it goes to 17 or higher, or above soft 17 if it
+    // hits soft 17.
+    while(dealer_count<17||(Rules::dealer_hits_soft_17&&dealer_count==17&&dealer_soft)){
+        int ind=deal_card();
+        char rank=show_rank(ind);
+        dealer_hand.push_back(rank);
+        add_card(dealer_state,dealer_count,dealer_soft,rank);
+    }
+    dealer_busted=dealer_state==HAND_BUST;
+}
+
+template<class Strategy, class Rules, class Statistics>
+void GameEngine<Strategy,Rules,Statistics>::settle(const int & result){
+    int bets=player_doubled_down ? 2 : 1;
+    player_bankroll+=result*bets*bet_size;
+    dealer_bankroll-=result*bets*bet_size;
+    if(result>0)
+        player_won+=1;
+    if(Statistics::outcomes&&result==0)
+        draws+=1;
+    if(Statistics::breakdown){
+        if(player_doubled_down&&result>0)
+            times_player_doubled_down_and_won++;
+        if(player_doubled_down&&result<0)
+            times_player_doubled_down_and_lost++;
+        if(split&&result>0)
+            times_player_split_and_won++;
+        if(split&&result<0)
+            times_player_split_and_lost++;
+    }
+    if(Statistics::bankroll_path)
+        player_time_series.push_back(player_bankroll);
+}
+
+template<class Strategy, class Rules, class Statistics>
+void GameEngine<Strategy,Rules,Statistics>::visit(const int & first, const int & row){
+    cell_visits[first+10*row+hand_rank(dealer_hand[0])]++;
+}
+
+template<class Strategy, class Rules, class Statistics>
+bool GameEngine<Strategy,Rules,Statistics>::ask_split_pair(const char & rank){
+    if(Statistics::cell_visits)
+        visit(0,hand_rank(rank));
+    return this->split_pair(rank,dealer_hand[0]);
+}
+
+template<class Strategy, class Rules, class Statistics>
+bool GameEngine<Strategy,Rules,Statistics>::ask_soft_double_down(){
+    // The soft hand of two cards is looked up by its card which is not
+    // the ace, the natural is not looked up.
+    char card=(player_hand[0]=='A') ? player_hand[1] : player_hand[0];
+    if(Statistics::cell_visits&&card!='T')
+        visit(100,hand_rank(card));
+    return this->soft_double_down(player_hand,dealer_hand[0]);
+}
+
+template<class Strategy, class Rules, class Statistics>
+bool GameEngine<Strategy,Rules,Statistics>::ask_hard_double_down(){
+    if(Statistics::cell_visits)
+        visit(200,player_count-2);
+    return this->hard_double_down(player_hand,dealer_hand[0]);
+}
+
+template<class Strategy, class Rules, class Statistics>
+bool GameEngine<Strategy,Rules,Statistics>::ask_soft_stand(){
+    if(Statistics::cell_visits)
+        visit(400,player_count-2);
+    return this->soft_stand(player_count,dealer_hand[0]);
+}
+
+template<class Strategy, class Rules, class Statistics>
+bool GameEngine<Strategy,Rules,Statistics>::ask_hard_stand(){
+    if(Statistics::cell_visits)
+        visit(600,player_count-2);
+    return this->hard_stand(player_hand.size(),player_count,dealer_hand[0],
+                            player_hand[0],player_hand[1]);
+}
+
+template<class Strategy, class Rules, class Statistics>
+void GameEngine<Strategy,Rules,Statistics>::one_round(){
+    // Dealing the pairs to player and dealer.
+    // The fist card dealt to dealer is face up.
+    int ind;
+    char rank;
+    // Deal card to player.
+    ind=deal_card();
+    rank=show_rank(ind);
+    player_hand.push_back(rank);
+    add_card(player_state,player_count,player_soft,rank);
+    // Deal card to dealer.
+    ind=deal_card();
+    rank=show_rank(ind);
+    dealer_hand.push_back(rank);
+    add_card(dealer_state,dealer_count,dealer_soft,rank);
+    // Deal card to player.
+    ind=deal_card();
+    rank=show_rank(ind);
+    if(rank==player_hand[0])
+        player_pair=true;
+    player_hand.push_back(rank);
+    add_card(player_state,player_count,player_soft,rank);
+    // Check for natural.
+    player_natural=player_state==HAND_NATURAL;
+    // Deal card to dealer.
+    ind=deal_card();
+    rank=show_rank(ind);
+    dealer_hand.push_back(rank);
+    add_card(dealer_state,dealer_count,dealer_soft,rank);
+    // Check for natural.
+    dealer_natural=dealer_state==HAND_NATURAL;
+    // Player's decisions.
+    // Split.
+    if(player_pair){
+        split=ask_split_pair(player_hand[0]);
+    }
+    if(split){
+        if(Statistics::breakdown)
+            times_player_split++;
+        char player_rank=player_hand[0];
+        // Play the split hands one after another, a resplit adding one
+        // more hand to play.
+        split_hands=2;
+        for(int hand=0;hand<split_hands;++hand){
+            player_hand={player_rank};
+            set_state(player_state,player_count,player_soft,split_start[hand_rank(player_rank)]);
+            player_doubled_down=false;
+            player_busted=false;
+            split_round(player_rank);
+        }
+        return;
+    }
+    // Check for natural win/draw.
+    if(player_natural){
+        if(dealer_natural){
+            settle(0);
+            return;
+        }
+        // The payout in whole chips, the same for the player and the
+        // dealer; it is exact for the bets of RulesVariant::bet_multiple
+        // (see RulesRegistry.h), and rounded down for the others.
+        int natural=Rules::natural_pays*bet_size+1e-9;
+        player_bankroll+=natural;
+        dealer_bankroll-=natural;
+        player_won+=1;
+        if(Statistics::bankroll_path)
+            player_time_series.push_back(player_bankroll);
+        return;
+    }
+    // Surrender, which loses half of the bet.
+    if(Rules::surrender&&!dealer_natural&&!player_soft
+       &&surrender_hand(player_count,dealer_hand[0])){
+        int half=bet_size/2;
+        player_bankroll-=half;
+        dealer_bankroll+=half;
+        if(Statistics::bankroll_path)
+            player_time_series.push_back(player_bankroll);
+        return;
+    }
+    // Double down.
+    if(player_soft&&ask_soft_double_down()){
+        player_doubled_down=true;
+    }
+    else if(!player_soft&&ask_hard_double_down()){
+        player_doubled_down=true;
+    }
+    if(Statistics::breakdown&&player_doubled_down)
+        times_player_doubled_down++;
+    // Continue to checking the originally dealt pair for hit/stand.
+    while(true){
+        // If player doubled down and its hand size is less than 3, we
+        // have to deal one more card to the player, so we cannot break.
+        if(!(player_doubled_down&&player_hand.size()<3)&&player_count==21)
+            break;
+        // If player's hand is soft check whether it should stand.
+        if(!(player_doubled_down&&player_hand.size()<3)
+           &&player_soft&&ask_soft_stand()){
+            break;
+        }
+        // If player's hand is hard check whether it should stand.
+        if(!(player_doubled_down&&player_hand.size()<3)
+           &&!player_soft&&ask_hard_stand()){
+            break;
+        }
+        // If player has doubled down it can receive only one more card.
+        if(player_doubled_down&&player_hand.size()==3){
+            break;
+        }
+        // Hit the player.
+        int ind=deal_card();
+        char rank=show_rank(ind);
+        player_hand.push_back(rank);
+        add_card(player_state,player_count,player_soft,rank);
+        player_busted=player_state==HAND_BUST;
+        if(player_busted){
+            settle(-1);
+            return;
+        }
+    }
+    // Dealer's hand.
+    play_dealer();
+    if(dealer_busted||player_count>dealer_count)
+        settle(1);
+    else if(player_count==dealer_count)
+        settle(0);
+    else
+        settle(-1);
+}
+
+template<class Strategy, class Rules, class Statistics>
+void GameEngine<Strategy,Rules,Statistics>::split_round(const char & player_rank){
+    int ind;
+    char rank;
+    // Deal card to player.
+    ind=deal_card();
+    rank=show_rank(ind);
+    // Resplit, the card of the same rank starting one more hand to play.
+    while(Rules::split_hands>2&&rank==player_rank&&split_hands<Rules::split_hands
+          &&ask_split_pair(player_rank)){
+        split_hands++;
+        ind=deal_card();
+        rank=show_rank(ind);
+    }
+    player_hand.push_back(rank);
+    add_card(player_state,player_count,player_soft,rank);
+    // Player's decisions.
+    // Double down. Can't double down on split aces. Therefore the soft hand
+    // is considered for double down only if we split non-aces and receive an ace.
+    if(Rules::double_after_split&&player_count!=21&&player_hand[0]!='A'
+       &&player_soft&&ask_soft_double_down()){
+        player_doubled_down=true;
+    }
+    else if(Rules::double_after_split&&player_count!=21&&player_hand[0]!='A'&&!player_soft
+            &&ask_hard_double_down()){
+        player_doubled_down=true;
+    }
+    if(Statistics::breakdown&&player_doubled_down)
+        times_player_doubled_down++;
+    // Continue to checking the originally dealt pair for hit/stand.
+    while(true){
+        if(!(player_doubled_down&&player_hand.size()<3)&&player_count==21)
+            break;
+        // If player's hand is soft check whether it should stand.
+        if(!(player_doubled_down&&player_hand.size()<3)
+           &&player_soft&&ask_soft_stand()){
+            break;
+        }
+        // If player's hand is hard check whether it should stand.
+        if(!(player_doubled_down&&player_hand.size()<3)
+           &&!player_soft&&ask_hard_stand()){
+            break;
+        }
+        // If player has split aces it can receive only up to the cards
+        // of split aces.
+        if(player_rank=='A'&&player_hand.size()==Rules::split_aces_cards){
+            break;
+        }
+        // If player has doubled down it can receive only one more card.
+        if(player_doubled_down&&player_hand.size()==3){
+            break;
+        }
+        // Hit the player
+        int ind=deal_card();
+        char rank=show_rank(ind);
+        player_hand.push_back(rank);
+        add_card(player_state,player_count,player_soft,rank);
+        player_busted=player_state==HAND_BUST;
+        if(player_busted){
+            settle(-1);
+            return;
+        }
+    }
+    // Dealer's hand. Only fill it if we are processing first split hand.
+    if(dealer_hand.size()==2)
+        play_dealer();
+    if(dealer_busted||player_count>dealer_count)
+        settle(1);
+    else if(player_count==dealer_count)
+        settle(0);
+    else
+        settle(-1);
+}
+
+template<class Strategy, class Rules, class Statistics>
+void GameEngine<Strategy,Rules,Statistics>::clear_for_next_round(){
+    player_soft=false;
+    dealer_soft=false;
+    player_count=0;
+    dealer_count=0;
+    player_doubled_down=false;
+    player_pair=false;
+    player_natural=false;
+    dealer_natural=false;
+    player_busted=false;
+    dealer_busted=false;
+    player_hand={};
+    dealer_hand={};
+    player_state=HAND_EMPTY;
+    dealer_state=HAND_EMPTY;
+    split=false;
+}
+
+// Reshuffling happens after we go through 1/3 of the deck (or of the
+// shoe of several decks).
+template<class Strategy, class Rules, class Statistics>
+bool GameEngine<Strategy,Rules,Statistics>::play_rounds(const int & rounds){
+    while(rounds_played<rounds){
+        if(player_bankroll<=0||dealer_bankroll<=0)
+            return true;
+        if(get_pointer()>get_order().size()/3){
+            reset();
+        }
+        ++rounds_played;
+        clear_for_next_round();
+        one_round();
+    }
+    return false;
+}
+
+template<class Strategy, class Rules, class Statistics>
+void GameEngine<Strategy,Rules,Statistics>::play(const int & rounds){
+    if(play_rounds(rounds)){
+        // this is sepcific for our genetic selection goals,
+        // to kill strategies which make the player go bankrupt.
+        player_won=0;
+    }
+}
+
+template<class Strategy, class Rules, class Statistics>
+void GameEngine<Strategy,Rules,Statistics>::play(const int & rounds, const int & A, const int & B){
+    play_rounds(rounds);
+}
@@ -0,0 +1,125 @@
+/**
+
+ Hand state, the whole of what the rules need to know about a hand of
+ blackjack as one small integer, and the table of the transitions from
+ one state to the next when a card is added to the hand. The player's
+ and the dealer's hands in Game.h and SharedDeal.h are played through
+ this one table instead of each repeating the bookkeeping of the aces.
+ It is in the Common directory, included by both the Evolve_strategy and
+ Test_strategy modules.
+
+ The states are:
+
+ * 0 the empty hand, 1 to 21 the hard totals,
+ * 22 to 32 the soft totals 11 to 21, the hands with one ace counted as
+   11 (the soft 11 is a single ace of a split pair),
+ * 33 the single ace and 34 the single ten of the initial deal, which
+   become the natural with a ten or an ace,
+ * 35 the natural, and 36 the bust.
+
+ The single ace and the single ten are states of their own only so that
+ the natural can be told apart from other 21s: a split hand starts from
+ the plain state of its card (see split_start), so its two-card 21 is a
+ soft 21 and not a natural.
+
+ The transitions are exactly those of the hand played card by card in
+ Game.h: an ace added to a hard hand counts 11 if the total stays at 21
+ or below, an ace added to a soft hand counts 1, and a soft hand which
+ would go over 21 becomes hard. The natural takes further cards as the
+ soft 21, so that the dealer's natural stands like any other 21.
+
+ */
+
+using namespace std;
+
+// Ranks are the card indexes of Chromosome.h: 0 for 'A', 1 to 8 for '2'
+// to '9', 9 for 'T'.
+const int HAND_ACE=0;
+const int HAND_TEN=9;
+
+const int HAND_EMPTY=0;
+const int HAND_SINGLE_ACE=33;
+const int HAND_SINGLE_TEN=34;
+const int HAND_NATURAL=35;
+const int HAND_BUST=36;
+const int HAND_STATES=37;
+
+// State of the hand after a card of the given rank is added to the hand
+// in the given state.
+constexpr unsigned char hand_next[HAND_STATES][10]={
+    {33, 2, 3, 4, 5, 6, 7, 8, 9,34}, // empty hand
+    {23, 3, 4, 5, 6, 7, 8, 9,10,11}, // hard 1
+    {24, 4, 5, 6, 7, 8, 9,10,11,12}, // hard 2
+    {25, 5, 6, 7, 8, 9,10,11,12,13}, // hard 3
+    {26, 6, 7, 8, 9,10,11,12,13,14}, // hard 4
+    {27, 7, 8, 9,10,11,12,13,14,15}, // hard 5
+    {28, 8, 9,10,11,12,13,14,15,16}, // hard 6
+    {29, 9,10,11,12,13,14,15,16,17}, // hard 7
+    {30,10,11,12,13,14,15,16,17,18}, // hard 8
+    {31,11,12,13,14,15,16,17,18,19}, // hard 9
+    {32,12,13,14,15,16,17,18,19,20}, // hard 10
+    {12,13,14,15,16,17,18,19,20,21}, // hard 11
+    {13,14,15,16,17,18,19,20,21,36}, // hard 12
+    {14,15,16,17,18,19,20,21,36,36}, // hard 13
+    {15,16,17,18,19,20,21,36,36,36}, // hard 14
+    {16,17,18,19,20,21,36,36,36,36}, // hard 15
+    {17,18,19,20,21,36,36,36,36,36}, // hard 16
+    {18,19,20,21,36,36,36,36,36,36}, // hard 17
+    {19,20,21,36,36,36,36,36,36,36}, // hard 18
+    {20,21,36,36,36,36,36,36,36,36}, // hard 19
+    {21,36,36,36,36,36,36,36,36,36}, // hard 20
+    {36,36,36,36,36,36,36,36,36,36}, // hard 21
+    {23,24,25,26,27,28,29,30,31,32}, // soft 11
+    {24,25,26,27,28,29,30,31,32,12}, // soft 12
+    {25,26,27,28,29,30,31,32,12,13}, // soft 13
+    {26,27,28,29,30,31,32,12,13,14}, // soft 14
+    {27,28,29,30,31,32,12,13,14,15}, // soft 15
+    {28,29,30,31,32,12,13,14,15,16}, // soft 16
+    {29,30,31,32,12,13,14,15,16,17}, // soft 17
+    {30,31,32,12,13,14,15,16,17,18}, // soft 18
+    {31,32,12,13,14,15,16,17,18,19}, // soft 19
+    {32,12,13,14,15,16,17,18,19,20}, // soft 20
+    {36,13,14,15,16,17,18,19,20,21}, // soft 21
+    {23,24,25,26,27,28,29,30,31,35}, // single ace
+    {35,12,13,14,15,16,17,18,19,20}, // single ten
+    {36,13,14,15,16,17,18,19,20,21}, // natural
+    {36,36,36,36,36,36,36,36,36,36}  // bust
+};
+
+// Count of the hand in each state, with the ace counted as 11 in soft
+// hands. The bust counts 22.
+constexpr unsigned char hand_total[HAND_STATES]={
+     0, 1, 2, 3, 4, 5, 6, 7, 8, 9,10,
+    11,12,13,14,15,16,17,18,19,20,21,
+    11,12,13,14,15,16,17,18,19,20,21,
+    11,10,21,22
+};
+
+// Whether the hand in each state is soft.
+constexpr bool hand_soft[HAND_STATES]={
+     0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+     0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+     1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+     1, 0, 1, 0
+};
+
+// State of a split hand holding the single card of the given rank.
+constexpr unsigned char split_start[10]={22,2,3,4,5,6,7,8,9,10};
+
+// Rank of the card with the given index in the fixed order of the Deck
+// ('2' to 'A', four suits each).
+constexpr unsigned char card_rank[52]={
+     1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4,
+     4, 4, 4, 5, 5, 5, 5, 6, 6, 6, 6, 7, 7,
+     7, 7, 8, 8, 8, 8, 9, 9, 9, 9, 9, 9, 9,
+     9, 9, 9, 9, 9, 9, 9, 9, 9, 0, 0, 0, 0
+};
+
+// Rank of the given rank character of the Deck ('2' to '9', 'T', 'A').
+int hand_rank(const char & rank){
+    if(rank=='A')
+        return HAND_ACE;
+    if(rank=='T')
+        return HAND_TEN;
+    return rank-'1';
+}
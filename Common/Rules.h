@@ -0,0 +1,99 @@
+/**
+
+ House rules of the game as compile-time policies. The game of Engine.h
+ is a template on the rules (GameEngine), and each set of rules below is
+ a struct of constants which the template reads, so every variant is
+ compiled into its own game with the branches of the other rules taken
+ out. Game of both modules is the GameEngine of RulesS17, the rules the
+ game has always been played with. It is in the Common directory,
+ included by both the Evolve_strategy and Test_strategy modules.
+
+ The variants a tool can pick at run time, by name or by number, are the
+ ones listed in the registry of RulesRegistry.h. A new variant is a new
+ struct here, usually inheriting from one of the others and changing some
+ of their constants, plus its line in the registry.
+
+ The chromosome has no genes for the surrender, so the rules with the
+ surrender surrender the hands of the usual basic strategy (see
+ surrender_hand() below). Resplit pairs are split again if the split gene
+ of the pair says so, the same as for the first split.
+
+ The bankrolls are whole numbers, so the player's bankroll after the
+ payout of the natural or the surrender is rounded down: the natural
+ paying 6:5 needs a bet size which is a multiple of 5 to be paid in full.
+
+ */
+
+using namespace std;
+
+// The rules of Game.h: single deck, dealer stands on soft 17, double
+// down after split (but not on split aces), no resplit, split aces
+// receive up to 3 cards per hand, no surrender, natural pays 3:2.
+struct RulesS17{
+    // Number of decks in the shoe.
+    static constexpr int decks=1;
+    // Whether the dealer hits soft 17.
+    static constexpr bool dealer_hits_soft_17=false;
+    // Whether the player can double down on split hands.
+    static constexpr bool double_after_split=true;
+    // Number of hands a pair can be split into, 2 if there is no resplit.
+    static constexpr int split_hands=2;
+    // Cards a hand of split aces can hold.
+    static constexpr int split_aces_cards=3;
+    // Whether the player can surrender (late surrender, only when the
+    // dealer has no natural).
+    static constexpr bool surrender=false;
+    // What the natural pays, in bets.
+    static constexpr double natural_pays=1.5;
+};
+
+// Dealer hits soft 17.
+struct RulesH17 : public RulesS17{
+    static constexpr bool dealer_hits_soft_17=true;
+};
+
+// No double down after split.
+struct RulesNoDAS : public RulesS17{
+    static constexpr bool double_after_split=false;
+};
+
+// Natural pays 6:5.
+struct RulesSixToFive : public RulesS17{
+    static constexpr double natural_pays=1.2;
+};
+
+// Late surrender.
+struct RulesSurrender : public RulesS17{
+    static constexpr bool surrender=true;
+};
+
+// Six deck shoe, dealer stands on soft 17, resplit up to 4 hands, split
+// aces receive one card each, late surrender.
+struct RulesShoeS17 : public RulesS17{
+    static constexpr int decks=6;
+    static constexpr int split_hands=4;
+    static constexpr int split_aces_cards=2;
+    static constexpr bool surrender=true;
+};
+
+// The six deck shoe with the dealer hitting soft 17.
+struct RulesShoeH17 : public RulesShoeS17{
+    static constexpr bool dealer_hits_soft_17=true;
+};
+
+// Most bets a round can cost under the rules: the hands of a split pair
+// are at most split_hands, and each of them can be doubled down.
+template<class Rules>
+constexpr int max_bets(){
+    return 2*Rules::split_hands;
+}
+
+// Whether the player surrenders the given hard count of two cards against
+// the given dealer's upcard: 16 against '9', 'T' and 'A', 15 against 'T'.
+bool surrender_hand(const int & count, const char & dealer_card){
+    if(count==16)
+        return dealer_card=='9'||dealer_card=='T'||dealer_card=='A';
+    if(count==15)
+        return dealer_card=='T';
+    return false;
+}
@@ -0,0 +1,479 @@
+/**
+
+ Shared deal: many strategies playing the same stream of cards at once,
+ so that the shuffles, the initial deal and the dealer's play of each
+ round are done once for all of them instead of once per strategy. It is
+ in the Common directory, included by both the Evolve_strategy and
+ Test_strategy modules.
+
+ SharedDeal deals the rounds. Every round is played on its own freshly
+ shuffled deck (or on the next shoe of a shoe bank, see ShoeBank.h):
+
+ * the cards 0 to 3 are the initial deal, player, dealer (face up),
+   player, dealer, the same as in Game::one_round(),
+ * the dealer draws from the back of the deck, the cards 51, 50, ...,
+ * each player draws from the front of the deck, from the card 4 on,
+   through a cursor of its own.
+
+ The dealer's hand therefore doesn't depend on how many cards a strategy
+ drew, and it is played once per round for all strategies. A strategy
+ which draws a different number of cards than another one only moves
+ its own cursor, and the next round starts on the next deck for all of
+ them, so the strategies never get out of step. As the cards of a
+ shuffled deck are all equally likely in any position, drawing the
+ dealer's cards from the back deals the same as drawing them after the
+ player's (the cursors can't meet: a round never uses more than about 35
+ cards).
+
+ DealerSampler holds the distributions of the final outcome of the
+ dealer's hand, so that SharedDeal can sample the dealer's outcome with
+ one random number per round instead of drawing the dealer's cards (see
+ SharedDeal::set_dealer_sampler()). The outcomes are the totals 17 to 21,
+ the natural, and the bust, with the dealer standing on soft 17:
+
+ * with zero decks the cards are drawn from an infinite deck, each rank
+   with the probability 1/13 (4/13 for 'T'), and the distribution depends
+   only on the dealer's upcard. SharedDeal then draws the player's cards
+   from the infinite deck too, one random number per card, and doesn't
+   shuffle at all,
+ * with one or more decks the distribution is for the cards left in the
+   shoe of that many decks once the player's two cards and the dealer's
+   upcard are dealt, for each of these three cards. It takes into account
+   which cards are gone before the dealer draws, but not the cards which
+   the player draws afterwards. SharedDeal still deals the player's cards
+   from the shuffled deck.
+
+ The distributions are calculated exactly, by going through all the ways
+ the dealer's hand can be played out, once when the sampler is made.
+
+ SharedPlayer plays the rounds of one strategy, read from its 800 genes,
+ with the same rules and decisions as Game.h. The hands are played
+ through the transition table of HandState.h, as in Game.h. The fit scores differ from
+ those of Game::play() only in that Game::play() plays up to a third of
+ the deck before it reshuffles, while here every round starts on a full
+ deck.
+
+ The shared deal plays only the rules of Game, RulesS17 of Rules.h: one
+ deck, the dealer standing on soft 17, double down after split, no
+ resplit, up to 3 cards on split aces, no surrender, the natural paying
+ 1.5. SharedPlayer and the dealer's play in SharedDeal::next() (and the
+ distributions of the DealerSampler) are written for these rules, not
+ read from the Rules policy of the GameEngine, so the other rules of
+ RulesRegistry.h can't be played on the shared deal.
+
+ */
+
+using namespace std;
+
+// Index of the player's count 2 to 21 in the tables, the same as
+// Chromosome::sum_index().
+int shared_sum_index(const int & count){
+    if(count<2||count>21)
+        return 0;
+    return count-2;
+}
+
+// Outcomes of the dealer's hand: 0 to 4 for the totals 17 to 21, then
+// the natural and the bust.
+const int DEALER_OUTCOMES=7;
+const int DEALER_NATURAL=5;
+const int DEALER_BUST=6;
+
+class DealerSampler{
+public:
+    // Constructor takes the number of decks, zero for an infinite deck.
+    DealerSampler(int);
+    // Outcome of the dealer's hand for the given upcard and player's two
+    // cards (ranks as in HandState.h), for the given number from 0 to 1.
+    int sample(const int &, const int &, const int &, const double &) const;
+    // Probability of the given outcome, for the given upcard and player's
+    // two cards.
+    double probability(const int &, const int &, const int &, const int &) const;
+    // Interfaces to private variables.
+    int get_decks() const{
+        return decks;
+    }
+private:
+    // Play the dealer's hand on from the given state (see HandState.h),
+    // with the given ranks left in the shoe, and add the probability of
+    // each outcome, times the given probability.
+    void play(const int &, array<int,10> &, const int &, const double &,
+              array<double,DEALER_OUTCOMES> &);
+    // Index of the distribution for the upcard and player's two cards.
+    int index(const int &, const int &, const int &) const;
+    int decks;
+    // Cumulative distributions of the outcomes.
+    vector<array<double,DEALER_OUTCOMES>> cumulative;
+};
+
+DealerSampler::DealerSampler(int d){
+    decks=max(0,d);
+    int tables=(decks==0) ? 10 : 1000;
+    cumulative=vector<array<double,DEALER_OUTCOMES>>(tables);
+    for(int up=0;up<10;++up)
+        for(int first=0;first<10;++first)
+            for(int second=0;second<10;++second){
+                if(decks==0&&(first>0||second>0))
+                    continue;
+                array<int,10> left;
+                for(int r=0;r<10;++r)
+                    left[r]=(r==HAND_TEN ? 16 : 4)*decks;
+                if(decks>0){
+                    left[first]--;
+                    left[second]--;
+                    left[up]--;
+                    if(left[first]<0||left[second]<0||left[up]<0)
+                        continue;
+                }
+                int cards=52*decks-3;
+                array<double,DEALER_OUTCOMES> outcomes={};
+                play(hand_next[HAND_EMPTY][up],left,cards,1,outcomes);
+                array<double,DEALER_OUTCOMES> & c=cumulative[index(up,first,second)];
+                double sum=0;
+                for(int o=0;o<DEALER_OUTCOMES;++o){
+                    sum+=outcomes[o];
+                    c[o]=sum;
+                }
+                // So that every number below 1 finds its outcome.
+                c[DEALER_OUTCOMES-1]=1;
+            }
+}
+
+int DealerSampler::index(const int & up, const int & first, const int & second) const{
+    if(decks==0)
+        return up;
+    return 100*up+10*first+second;
+}
+
+void DealerSampler::play(const int & state, array<int,10> & left, const int & total,
+                         const double & prob, array<double,DEALER_OUTCOMES> & outcomes){
+    if(state==HAND_BUST){
+        outcomes[DEALER_BUST]+=prob;
+        return;
+    }
+    if(state==HAND_NATURAL){
+        outcomes[DEALER_NATURAL]+=prob;
+        return;
+    }
+    if(hand_total[state]>=17){
+        outcomes[hand_total[state]-17]+=prob;
+        return;
+    }
+    for(int rank=0;rank<10;++rank){
+        double p=(decks==0) ? (rank==HAND_TEN ? 4.0 : 1.0)/13 : (double) left[rank]/total;
+        if(p==0)
+            continue;
+        left[rank]--;
+        play(hand_next[state][rank],left,total-1,prob*p,outcomes);
+        left[rank]++;
+    }
+}
+
+int DealerSampler::sample(const int & up, const int & first, const int & second,
+                          const double & u) const{
+    const array<double,DEALER_OUTCOMES> & c=cumulative[index(up,first,second)];
+    int o=0;
+    while(o<DEALER_OUTCOMES-1&&u>=c[o])
+        ++o;
+    return o;
+}
+
+double DealerSampler::probability(const int & up, const int & first, const int & second,
+                                  const int & outcome) const{
+    const array<double,DEALER_OUTCOMES> & c=cumulative[index(up,first,second)];
+    return outcome==0 ? c[0] : c[outcome]-c[outcome-1];
+}
+
+class SharedDeal{
+public:
+    // Deal on the decks shuffled by the engine seeded by the given seed.
+    SharedDeal(const unsigned &);
+    // Deal on the given number of shoes of the given number of cards
+    // (see ShoeBank::shoes()), one per round, starting over after the last.
+    // The seed is used only to sample the dealer's outcome.
+    SharedDeal(const unsigned char *, const int &, const unsigned long long &,
+               const unsigned & =1);
+    // Sample the dealer's outcome from the given sampler instead of
+    // drawing the dealer's cards, nullptr to draw them again. With an
+    // infinite deck sampler the cards are drawn from the infinite deck.
+    // The sampler must outlive the deal.
+    void set_dealer_sampler(const DealerSampler *);
+    // Deal the next round and play the dealer's hand.
+    void next();
+    // Rank of the card 'k' of the current deck. The cards of the infinite
+    // deck are drawn when they are first asked for.
+    int rank(const int & k) const{
+        while(infinite&&dealt<=k)
+            ranks[dealt++]=infinite_rank();
+        return ranks[k];
+    }
+    // Interfaces to private variables.
+    int get_dealer_count() const{
+        return dealer_count;
+    }
+    bool get_dealer_busted() const{
+        return dealer_busted;
+    }
+    bool get_dealer_natural() const{
+        return dealer_natural;
+    }
+private:
+    // Rank of a card drawn from the infinite deck.
+    int infinite_rank() const{
+        // The 13 cards of a suit, with 'J', 'Q' and 'K' counted as 'T'.
+        unsigned long long r=(unsigned long long) engine()*13>>32;
+        return r>=9 ? HAND_TEN : r;
+    }
+    array<int,52> order;
+    mutable mt19937 engine;
+    // Sampler of the dealer's outcome, if any, and whether the cards are
+    // drawn from the infinite deck.
+    const DealerSampler * sampler;
+    bool infinite;
+    // Shoes of the shoe bank, if any, the cards per shoe, the number of
+    // shoes, and the shoe of the next round.
+    const unsigned char * bank;
+    int bank_cards;
+    unsigned long long bank_count;
+    unsigned long long bank_next;
+    // Ranks of the current deck, and the number of cards drawn from the
+    // infinite deck so far.
+    mutable array<int,52> ranks;
+    mutable int dealt;
+    // The dealer's hand played out.
+    int dealer_count;
+    bool dealer_busted;
+    bool dealer_natural;
+};
+
+SharedDeal::SharedDeal(const unsigned & seed) : engine(seed){
+    for(int i=0;i<52;++i)
+        order[i]=i;
+    bank=nullptr;
+    sampler=nullptr;
+    infinite=false;
+}
+
+SharedDeal::SharedDeal(const unsigned char * shoes, const int & cards,
+                       const unsigned long long & count, const unsigned & seed) : engine(seed){
+    bank=shoes;
+    bank_cards=cards;
+    bank_count=max(1ULL,count);
+    bank_next=0;
+    sampler=nullptr;
+    infinite=false;
+}
+
+void SharedDeal::set_dealer_sampler(const DealerSampler * s){
+    sampler=s;
+    infinite=sampler!=nullptr&&sampler->get_decks()==0;
+}
+
+void SharedDeal::next(){
+    if(infinite){
+        // The dealer's hole card is not drawn, its outcome is sampled.
+        dealt=0;
+        rank(2);
+        ranks[3]=-1;
+        dealt=4;
+    }
+    else if(bank!=nullptr){
+        const unsigned char * shoe=bank+bank_next*bank_cards;
+        for(int i=0;i<52;++i)
+            ranks[i]=card_rank[shoe[i]];
+        bank_next=(bank_next+1)%bank_count;
+    }
+    else{
+        shuffle(order.begin(),order.end(),engine);
+        for(int i=0;i<52;++i)
+            ranks[i]=card_rank[order[i]];
+    }
+    if(sampler!=nullptr){
+        double u=engine()*(1.0/4294967296.0);
+        int outcome=sampler->sample(ranks[1],ranks[0],ranks[2],u);
+        dealer_natural=outcome==DEALER_NATURAL;
+        dealer_busted=outcome==DEALER_BUST;
+        dealer_count=dealer_natural ? 21 : 17+outcome;
+        return;
+    }
+    // The dealer's two cards, then the dealer hits from the back of the
+    // deck until 17 or higher, the same as in Game::one_round().
+    int state=hand_next[hand_next[HAND_EMPTY][ranks[1]]][ranks[3]];
+    dealer_natural=state==HAND_NATURAL;
+    int back=51;
+    while(hand_total[state]<17)
+        state=hand_next[state][ranks[back--]];
+    dealer_busted=state==HAND_BUST;
+    dealer_count=hand_total[state];
+}
+
+class SharedPlayer{
+public:
+    // Constructor takes the 800 genes of the strategy, the initial
+    // bankrolls of the player and the dealer, and the bet size.
+    SharedPlayer(const vector<int> &, int, int, int);
+    // Play the current round of the deal, unless the player or the
+    // dealer went bankrupt.
+    void play_round(const SharedDeal &);
+    // False once the player or the dealer went bankrupt.
+    bool active(){
+        return player_bankroll>0&&dealer_bankroll>0;
+    }
+    // Interfaces to private variables.
+    int get_player_bankroll(){
+        return player_bankroll;
+    }
+    int get_dealer_bankroll(){
+        return dealer_bankroll;
+    }
+    int get_player_won(){
+        return player_won;
+    }
+    int get_draws(){
+        return draws;
+    }
+    int get_rounds_played(){
+        return rounds_played;
+    }
+    // Position of the next card the player would draw in the current deck.
+    int get_cursor(){
+        return cursor;
+    }
+private:
+    // Play one hand from the given state (see HandState.h) and number of
+    // cards, and settle it. If split_rank is not -1 the hand is one of the
+    // hands of the split pair of that rank, which starts with a single card.
+    void play_hand(const SharedDeal &, int, int, const int &);
+    // Add the given number of bets to the player's bankroll.
+    void settle(const double &);
+    int player_bankroll;
+    int dealer_bankroll;
+    int bet_size;
+    int player_won;
+    int draws;
+    int rounds_played;
+    int cursor;
+    // Decisions, indexed as the matrices of Chromosome.h.
+    unsigned char split[10][10];
+    unsigned char soft_double_down[10][10];
+    unsigned char hard_double_down[20][10];
+    unsigned char soft_stand[20][10];
+    unsigned char hard_stand[20][10];
+};
+
+SharedPlayer::SharedPlayer(const vector<int> & chrom, int p, int d, int b){
+    player_bankroll=p;
+    dealer_bankroll=d;
+    bet_size=b;
+    player_won=0;
+    draws=0;
+    rounds_played=0;
+    cursor=4;
+    for(int i=0;i<10;++i)
+        for(int j=0;j<10;++j){
+            split[i][j]=chrom[10*i+j];
+            soft_double_down[i][j]=chrom[100+10*i+j];
+        }
+    for(int i=0;i<20;++i)
+        for(int j=0;j<10;++j){
+            hard_double_down[i][j]=chrom[200+10*i+j];
+            soft_stand[i][j]=chrom[400+10*i+j];
+            hard_stand[i][j]=chrom[600+10*i+j];
+        }
+}
+
+void SharedPlayer::settle(const double & bets){
+    // The same whole number of chips for the player and the dealer.
+    int amount=bets*bet_size;
+    player_bankroll+=amount;
+    dealer_bankroll-=amount;
+}
+
+void SharedPlayer::play_round(const SharedDeal & deal){
+    if(!active())
+        return;
+    ++rounds_played;
+    cursor=4;
+    int first=deal.rank(0);
+    int up=deal.rank(1);
+    int state=hand_next[hand_next[HAND_EMPTY][first]][deal.rank(2)];
+    // Split, each hand starting with one card of the pair.
+    if(first==deal.rank(2)&&split[first][up]==1){
+        play_hand(deal,split_start[first],1,first);
+        play_hand(deal,split_start[first],1,first);
+        return;
+    }
+    // Natural.
+    if(state==HAND_NATURAL){
+        if(deal.get_dealer_natural()){
+            draws++;
+            return;
+        }
+        settle(1.5);
+        player_won++;
+        return;
+    }
+    play_hand(deal,state,2,-1);
+}
+
+void SharedPlayer::play_hand(const SharedDeal & deal, int state, int cards,
+                             const int & split_rank){
+    int up=deal.rank(1);
+    bool split_aces=split_rank==HAND_ACE;
+    // The second card of a split hand.
+    if(cards==1){
+        state=hand_next[state][deal.rank(cursor++)];
+        cards=2;
+    }
+    // A hard hand of two cards holds no ace, so its count is also the
+    // total of the hard double down.
+    int count=hand_total[state];
+    bool soft=hand_soft[state];
+    // Double down, not on split aces and not on 21 of a split hand.
+    bool doubled=false;
+    if(split_rank==-1){
+        if(soft){
+            int other=(deal.rank(0)==HAND_ACE) ? deal.rank(2) : deal.rank(0);
+            doubled=other!=HAND_TEN&&soft_double_down[other][up]==1;
+        }
+        else
+            doubled=hard_double_down[shared_sum_index(count)][up]==1;
+    }
+    else if(count!=21&&!split_aces){
+        if(soft)
+            doubled=split_rank!=HAND_TEN&&soft_double_down[split_rank][up]==1;
+        else
+            doubled=hard_double_down[shared_sum_index(count)][up]==1;
+    }
+    // Hit until the strategy stands, or once after doubling down.
+    while(true){
+        bool must_hit=doubled&&cards<3;
+        if(!must_hit&&count==21)
+            break;
+        if(!must_hit&&soft&&soft_stand[shared_sum_index(count)][up]==1)
+            break;
+        if(!must_hit&&!soft&&hard_stand[shared_sum_index(count)][up]==1)
+            break;
+        if(split_aces&&cards==3)
+            break;
+        if(doubled&&cards==3)
+            break;
+        state=hand_next[state][deal.rank(cursor++)];
+        count=hand_total[state];
+        soft=hand_soft[state];
+        cards++;
+        if(state==HAND_BUST){
+            settle(doubled ? -2 : -1);
+            return;
+        }
+    }
+    double bets=doubled ? 2 : 1;
+    if(deal.get_dealer_busted()||count>deal.get_dealer_count()){
+        settle(bets);
+        player_won++;
+    }
+    else if(count==deal.get_dealer_count())
+        draws++;
+    else
+        settle(-bets);
+}
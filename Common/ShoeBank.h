@@ -0,0 +1,129 @@
+/**
+
+ Shoe bank (.bjb), a file of shuffled shoes generated once (see
+ make_shoe_bank.cpp) and then played by any number of evaluations, so
+ that runs made on different days, or by different tools, can be
+ compared on exactly the same cards. It is in the Common directory,
+ included by both the Evolve_strategy and Test_strategy modules.
+
+ The file is in the native (little-endian) byte order:
+
+ * 32 byte header (ShoeBankHeader below): uint32 magic 0x42534a42
+   ("BJSB"), uint32 version 1, uint32 number of decks per shoe, uint32
+   cards per shoe (52 per deck), uint64 number of shoes, uint64 seed the
+   shoes were shuffled with,
+ * the shoes back to back, one byte per card. The byte is the index of
+   the card in the fixed order of the Deck (the "cards" array of Deck.h),
+   so its rank is the byte divided by 4 ('2' to 'A'); a shoe of several
+   decks holds each index as many times as there are decks.
+
+ ShoeBank maps the file into memory read-only (see MappedFile in
+ StrategyFile.h), so the threads of a process share one copy of it, and
+ the processes reading the same bank share the pages of the file. An
+ evaluation uses the shoes from 'first' to 'first+count' (see shoes()),
+ handed to the Deck with Deck::use_bank(). The Deck then takes its cards
+ from the next shoe of the range at every reset instead of shuffling,
+ starting over from the first one at the end of the range. A Deck plays
+ the first cards of a shoe of more decks than it has, and needs shoes of
+ at least as many decks as it has.
+
+ */
+
+using namespace std;
+
+const unsigned SHOE_BANK_MAGIC=0x42534a42;
+const unsigned SHOE_BANK_VERSION=1;
+
+struct ShoeBankHeader{
+    unsigned magic;
+    unsigned version;
+    unsigned decks;
+    unsigned cards;
+    unsigned long long shoes;
+    unsigned long long seed;
+};
+
+// Write the bank of the given number of shoes of the given number of
+// decks, shuffled by the engine seeded by the given seed. True if
+// successful.
+bool write_shoe_bank(const string & file, const unsigned long long & shoes,
+                     const unsigned & decks, const unsigned long long & seed){
+    ShoeBankHeader h={SHOE_BANK_MAGIC,SHOE_BANK_VERSION,decks,52*decks,shoes,seed};
+    mt19937_64 engine(seed);
+    vector<unsigned char> shoe(h.cards);
+    // Written through a buffer of many shoes, as the bank can be large.
+    vector<unsigned char> buffer;
+    buffer.reserve(1<<20);
+    string tmp=file+".tmp";
+    {
+        ofstream os(tmp,ios::binary);
+        os.write((const char *) &h,sizeof(h));
+        for(unsigned long long k=0;k<shoes;++k){
+            // Every shuffle starts from the fixed order, so that each shoe
+            // depends only on the engine.
+            for(int c=0;c<h.cards;++c)
+                shoe[c]=c%52;
+            shuffle(shoe.begin(),shoe.end(),engine);
+            buffer.insert(buffer.end(),shoe.begin(),shoe.end());
+            if(buffer.size()+h.cards>buffer.capacity()||k==shoes-1){
+                os.write((const char *) buffer.data(),buffer.size());
+                buffer.clear();
+            }
+        }
+        if(!os)
+            return false;
+    }
+    return rename(tmp.c_str(),file.c_str())==0;
+}
+
+class ShoeBank{
+public:
+    // Constructor takes the bank file.
+    ShoeBank(const string &);
+    // False if the file is not a valid bank.
+    bool valid(){
+        return header!=nullptr;
+    }
+    // Number of shoes, decks per shoe, and cards per shoe.
+    unsigned long long size(){
+        return header ? header->shoes : 0;
+    }
+    int decks(){
+        return header ? header->decks : 0;
+    }
+    int cards(){
+        return header ? header->cards : 0;
+    }
+    unsigned long long seed(){
+        return header ? header->seed : 0;
+    }
+    // The first of the 'count' shoes starting at the shoe 'first', which
+    // follow one another in memory. The count is cut to the size of the
+    // bank, and 'first' is taken modulo the number of ranges of 'count'
+    // shoes which fit into it, so any number (a seed) can be used.
+    const unsigned char * shoes(unsigned long long first, unsigned long long & count);
+private:
+    MappedFile file;
+    const ShoeBankHeader * header;
+    const unsigned char * data;
+};
+
+ShoeBank::ShoeBank(const string & f) : file(f){
+    header=nullptr;
+    const ShoeBankHeader * h=(const ShoeBankHeader *) file.data();
+    if(file.size()<sizeof(ShoeBankHeader)||h->magic!=SHOE_BANK_MAGIC
+       ||h->version!=SHOE_BANK_VERSION||h->shoes==0||h->cards<52
+       ||h->cards!=52*h->decks
+       ||sizeof(ShoeBankHeader)+h->shoes*h->cards!=file.size()){
+        cerr << "Not a valid shoe bank: " << f << endl;
+        return;
+    }
+    header=h;
+    data=(const unsigned char *) (file.data()+sizeof(ShoeBankHeader));
+}
+
+const unsigned char * ShoeBank::shoes(unsigned long long first, unsigned long long & count){
+    count=max(1ULL,min(count,size()));
+    first%=size()-count+1;
+    return data+first*header->cards;
+}
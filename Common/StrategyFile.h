@@ -0,0 +1,263 @@
+/**
+
+ Binary strategy format (.bjs), the compact replacement for the 800
+ comma-separated entries of strategy_chromosome.csv and chrom.csv. It is
+ in the Common directory, included by both the Evolve_strategy and
+ Test_strategy modules.
+
+ A .bjs file holds one or more strategies back to back, each of them in
+ the native (little-endian) byte order:
+
+ * 32 byte header (StrategyHeader below): uint32 magic 0x54534a42
+   ("BJST"), uint16 version 1, uint16 flags, uint32 number of genes
+   (800), uint32 rules (the number of the rules in the registry of
+   RulesRegistry.h, 0 for the rules of Game.h, the same as in the
+   requests of evaluation_server.cpp), uint32 checksum of the payloads
+   (32-bit FNV-1a), 12 reserved bytes (zero),
+ * the genes packed 8 per byte, gene k being the bit k%8 of the byte k/8
+   (the same as pack_chromosome() in Chromosome.h), 100 bytes,
+ * if the flag STRATEGY_MEAN is set, the mean strategy as float32 per
+   gene, the probability of each gene to be 1 (the same as chrom.csv);
+   the packed genes are then the mean rounded to 0 or 1.
+
+ The file is mapped into memory (MappedFile) and the strategies are read
+ in place (StrategyView), so that loading many strategies costs only the
+ check of their headers and checksums. csv_to_strategy() and
+ strategy_to_csv() convert between the .bjs and the CSV files, see also
+ convert_strategy.cpp.
+
+ */
+
+using namespace std;
+
+const unsigned STRATEGY_MAGIC=0x54534a42;
+const unsigned short STRATEGY_VERSION=1;
+// Flag of the strategies which carry the mean strategy.
+const unsigned short STRATEGY_MEAN=1;
+
+struct StrategyHeader{
+    unsigned magic;
+    unsigned short version;
+    unsigned short flags;
+    unsigned genes;
+    unsigned rules;
+    unsigned checksum;
+    unsigned reserved[3];
+};
+
+// 32-bit FNV-1a hash of the given bytes, continuing from the given hash.
+unsigned strategy_checksum(const unsigned char * data, size_t size,
+                           unsigned hash=2166136261u){
+    for(size_t k=0;k<size;++k){
+        hash^=data[k];
+        hash*=16777619u;
+    }
+    return hash;
+}
+
+// Size of the packed genes, rounded up to whole float32 entries.
+size_t strategy_packed_size(const unsigned & genes){
+    return (genes+31)/32*4;
+}
+
+// Size of the strategy with the given header, header included.
+size_t strategy_size(const StrategyHeader & h){
+    size_t size=sizeof(StrategyHeader)+strategy_packed_size(h.genes);
+    if(h.flags&STRATEGY_MEAN)
+        size+=4*h.genes;
+    return size;
+}
+
+// A strategy read in place from memory, valid while the memory is.
+struct StrategyView{
+    const StrategyHeader * header;
+    const unsigned char * packed;
+    // Null unless the strategy carries the mean strategy.
+    const float * mean;
+    int gene(const int & k) const{
+        return (packed[k/8]>>(k%8))&1;
+    }
+    vector<int> chromosome() const{
+        vector<int> chrom(header->genes);
+        for(int k=0;k<chrom.size();++k)
+            chrom[k]=gene(k);
+        return chrom;
+    }
+    // The mean strategy, or the genes if there is no mean.
+    vector<double> mean_chromosome() const{
+        vector<double> chrom(header->genes);
+        for(int k=0;k<chrom.size();++k)
+            chrom[k]=(mean!=nullptr) ? mean[k] : gene(k);
+        return chrom;
+    }
+};
+
+// The strategies stored back to back in the given memory. Stops at the
+// first one which is not valid.
+vector<StrategyView> view_strategies(const char * data, const size_t & size){
+    vector<StrategyView> views;
+    size_t at=0;
+    while(at+sizeof(StrategyHeader)<=size){
+        const StrategyHeader * h=(const StrategyHeader *) (data+at);
+        if(h->magic!=STRATEGY_MAGIC||h->version!=STRATEGY_VERSION
+           ||at+strategy_size(*h)>size){
+            cerr << "Not a valid strategy at byte " << at << endl;
+            break;
+        }
+        const unsigned char * payload=(const unsigned char *) (h+1);
+        if(strategy_checksum(payload,strategy_size(*h)-sizeof(StrategyHeader))!=h->checksum){
+            cerr << "Wrong checksum of the strategy at byte " << at << endl;
+            break;
+        }
+        StrategyView view;
+        view.header=h;
+        view.packed=payload;
+        view.mean=nullptr;
+        if(h->flags&STRATEGY_MEAN)
+            view.mean=(const float *) (payload+strategy_packed_size(h->genes));
+        views.push_back(view);
+        at+=strategy_size(*h);
+    }
+    return views;
+}
+
+// Write one strategy to the stream; if the mean is not empty the genes
+// are the rounded mean.
+void write_strategy(ostream & os, const vector<int> & chrom,
+                    const vector<double> & mean={}, const unsigned & rules=0){
+    StrategyHeader h={STRATEGY_MAGIC,STRATEGY_VERSION,0,(unsigned) chrom.size(),
+                      rules,0,{0,0,0}};
+    vector<unsigned char> payload(strategy_packed_size(h.genes),0);
+    for(int k=0;k<chrom.size();++k)
+        if(chrom[k]==1)
+            payload[k/8]|=(1<<(k%8));
+    if(!mean.empty()){
+        h.flags|=STRATEGY_MEAN;
+        vector<float> m(mean.begin(),mean.end());
+        const unsigned char * bytes=(const unsigned char *) m.data();
+        payload.insert(payload.end(),bytes,bytes+4*m.size());
+    }
+    h.checksum=strategy_checksum(payload.data(),payload.size());
+    os.write((const char *) &h,sizeof(h));
+    os.write((const char *) payload.data(),payload.size());
+}
+
+// Write the mean strategy, with the genes being the rounded mean.
+void write_mean_strategy(ostream & os, const vector<double> & mean,
+                         const unsigned & rules=0){
+    vector<int> chrom;
+    for(double m : mean)
+        chrom.push_back(m>=0.5 ? 1 : 0);
+    write_strategy(os,chrom,mean,rules);
+}
+
+// A file mapped into memory for reading (read into memory if it can't
+// be mapped).
+class MappedFile{
+public:
+    MappedFile(const string &);
+    ~MappedFile();
+    const char * data(){
+        return start;
+    }
+    size_t size(){
+        return length;
+    }
+private:
+    MappedFile(const MappedFile &);
+    const char * start;
+    size_t length;
+    bool mapped;
+    vector<char> buffer;
+};
+
+MappedFile::MappedFile(const string & file){
+    start=nullptr;
+    length=0;
+    mapped=false;
+#ifdef __linux__
+    int fd=open(file.c_str(),O_RDONLY);
+    struct stat st;
+    if(fd>=0&&fstat(fd,&st)==0&&st.st_size>0){
+        void * p=mmap(nullptr,st.st_size,PROT_READ,MAP_SHARED,fd,0);
+        if(p!=MAP_FAILED){
+            start=(const char *) p;
+            length=st.st_size;
+            mapped=true;
+        }
+    }
+    if(fd>=0)
+        close(fd);
+#endif
+    if(!mapped){
+        ifstream is(file,ios::binary);
+        buffer.assign(istreambuf_iterator<char>(is),istreambuf_iterator<char>());
+        start=buffer.data();
+        length=buffer.size();
+    }
+}
+
+MappedFile::~MappedFile(){
+#ifdef __linux__
+    if(mapped)
+        munmap((void *) start,length);
+#endif
+}
+
+// The first strategy of the .bjs file, empty if there is none.
+vector<int> load_strategy(const string & file){
+    MappedFile f(file);
+    vector<StrategyView> views=view_strategies(f.data(),f.size());
+    if(views.empty())
+        return {};
+    return views[0].chromosome();
+}
+
+// True if the file name ends with .bjs.
+bool is_strategy_file(const string & file){
+    return file.size()>4&&file.substr(file.size()-4)==".bjs";
+}
+
+// Convert the CSV file with one strategy on its first line into the .bjs
+// file. Entries other than 0 and 1 make it a mean strategy.
+bool csv_to_strategy(const string & csv, const string & bjs){
+    ifstream is(csv);
+    string line;
+    if(!getline(is,line))
+        return false;
+    vector<double> values;
+    stringstream line_stream(line);
+    string entry;
+    while(getline(line_stream,entry,','))
+        values.push_back(stod(entry));
+    bool mean=false;
+    vector<int> chrom;
+    for(double v : values){
+        if(v!=0&&v!=1)
+            mean=true;
+        chrom.push_back(v>=0.5 ? 1 : 0);
+    }
+    ofstream os(bjs,ios::binary);
+    if(mean)
+        write_mean_strategy(os,values);
+    else
+        write_strategy(os,chrom);
+    return bool(os);
+}
+
+// Convert the first strategy of the .bjs file into the CSV file, the
+// mean strategy if it carries one.
+bool strategy_to_csv(const string & bjs, const string & csv){
+    MappedFile f(bjs);
+    vector<StrategyView> views=view_strategies(f.data(),f.size());
+    if(views.empty())
+        return false;
+    vector<double> chrom=views[0].mean_chromosome();
+    ofstream os(csv);
+    for(int k=0;k<chrom.size();++k){
+        os << chrom[k];
+        if(k<chrom.size()-1)
+            os << ",";
+    }
+    return bool(os);
+}
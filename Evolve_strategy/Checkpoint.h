@@ -0,0 +1,234 @@
+/**
+
+ Checkpoint is the full state of an Evolve run between two generations,
+ from which the run can be resumed exactly (see Evolve::checkpoint() and
+ the Evolve constructor taking a Checkpoint).
+
+ The checkpoint file is binary, in the native (little-endian) byte order,
+ laid out so that it can be mapped into memory and read in place:
+
+ * 64 byte header (CheckpointHeader below): magic 0x4b434a42 ("BJCK"),
+   version 1, the configuration of the run, the number of generations
+   done, the number of times the population was evaluated, the common
+   seed of the decks, and the sizes of the entries which follow,
+ * M float64 fit scores of the population,
+ * the float64 score time series, one entry per generation done,
+ * M*100 bytes, the population packed by pack_chromosome(),
+ * the state of the random engine of Evolve, as written by operator<<.
+
+ The resume is exact, that is the resumed run breeds and plays exactly
+ the same as the run which wrote the checkpoint, if the population is
+ played on the decks seeded by a common seed (see PoolEvaluator in
+ ThreadPool.h), since otherwise the shuffles are not repeatable anyway.
+
+ Checkpointer writes the checkpoints on its own thread, so that the
+ evolution doesn't wait for the disk. If a new checkpoint comes before the
+ previous one is written, only the new one is written. Each checkpoint is
+ first written to a temporary file, which then replaces the checkpoint
+ file, so that a crash while writing leaves the previous checkpoint.
+
+ */
+
+using namespace std;
+
+const unsigned CHECKPOINT_MAGIC=0x4b434a42;
+const unsigned CHECKPOINT_VERSION=1;
+
+struct CheckpointHeader{
+    unsigned magic;
+    unsigned version;
+    int p;
+    int d;
+    int b;
+    int M;
+    int R;
+    unsigned common_seed;
+    int generation;
+    int evaluations;
+    unsigned series_size;
+    unsigned engine_size;
+    double propagate;
+    double selection_rate;
+};
+
+struct Checkpoint{
+    // Initial bankrolls of player and dealer, bet size, propagation
+    // rate, selection rate, size of population and rounds played.
+    int p;
+    int d;
+    int b;
+    double propagate;
+    double selection_rate;
+    int M;
+    int R;
+    // Common seed of the decks, zero if the decks are not seeded.
+    unsigned common_seed;
+    // Number of generations done, and of evaluations of the population.
+    int generation;
+    int evaluations;
+    vector<double> fit_scores;
+    vector<double> score_time_series;
+    // Population packed by pack_chromosome(), 100 bytes each.
+    vector<unsigned char> population;
+    // State of the random engine, as written by operator<<.
+    string engine;
+};
+
+// Write the checkpoint to the file, true if successful.
+bool write_checkpoint(const string & file, const Checkpoint & c){
+    CheckpointHeader h={CHECKPOINT_MAGIC,CHECKPOINT_VERSION,c.p,c.d,c.b,c.M,c.R,
+                        c.common_seed,c.generation,c.evaluations,
+                        (unsigned) c.score_time_series.size(),
+                        (unsigned) c.engine.size(),c.propagate,c.selection_rate};
+    string tmp=file+".tmp";
+    {
+        ofstream os(tmp,ios::binary);
+        os.write((const char *) &h,sizeof(h));
+        os.write((const char *) c.fit_scores.data(),8*c.fit_scores.size());
+        os.write((const char *) c.score_time_series.data(),8*c.score_time_series.size());
+        os.write((const char *) c.population.data(),c.population.size());
+        os.write(c.engine.data(),c.engine.size());
+        if(!os)
+            return false;
+    }
+    return rename(tmp.c_str(),file.c_str())==0;
+}
+
+// Read the checkpoint from the file, false if there is none or it is
+// not valid. On Linux the file is mapped into memory instead of read.
+bool read_checkpoint(const string & file, Checkpoint & c){
+    const char * data=nullptr;
+    size_t size=0;
+    vector<char> buffer;
+#ifdef __linux__
+    int fd=open(file.c_str(),O_RDONLY);
+    if(fd<0)
+        return false;
+    struct stat st;
+    void * mapped=MAP_FAILED;
+    if(fstat(fd,&st)==0&&st.st_size>0){
+        size=st.st_size;
+        mapped=mmap(nullptr,size,PROT_READ,MAP_PRIVATE,fd,0);
+    }
+    close(fd);
+    if(mapped==MAP_FAILED)
+        return false;
+    data=(const char *) mapped;
+#else
+    ifstream is(file,ios::binary);
+    buffer.assign(istreambuf_iterator<char>(is),istreambuf_iterator<char>());
+    data=buffer.data();
+    size=buffer.size();
+#endif
+    CheckpointHeader h;
+    bool valid=size>=sizeof(h);
+    if(valid){
+        memcpy(&h,data,sizeof(h));
+        valid=h.magic==CHECKPOINT_MAGIC&&h.version==CHECKPOINT_VERSION&&h.M>0
+            &&size==sizeof(h)+8.0*h.M+8.0*h.series_size+100.0*h.M+h.engine_size;
+    }
+    if(valid){
+        c.p=h.p;
+        c.d=h.d;
+        c.b=h.b;
+        c.propagate=h.propagate;
+        c.selection_rate=h.selection_rate;
+        c.M=h.M;
+        c.R=h.R;
+        c.common_seed=h.common_seed;
+        c.generation=h.generation;
+        c.evaluations=h.evaluations;
+        const char * at=data+sizeof(h);
+        const double * fit_scores=(const double *) at;
+        c.fit_scores.assign(fit_scores,fit_scores+h.M);
+        at+=8*h.M;
+        const double * series=(const double *) at;
+        c.score_time_series.assign(series,series+h.series_size);
+        at+=8*h.series_size;
+        c.population.assign(at,at+100*h.M);
+        at+=100*h.M;
+        c.engine.assign(at,h.engine_size);
+    }
+#ifdef __linux__
+    munmap((void *) data,size);
+#endif
+    return valid;
+}
+
+class Checkpointer{
+public:
+    // Constructor takes the checkpoint file, the number of generations
+    // between the checkpoints, and the common seed of the decks the
+    // population is played on, which is recorded in the checkpoints.
+    Checkpointer(const string &, int, unsigned);
+    // Writes the last checkpoint and joins the writer thread.
+    ~Checkpointer();
+    // Hand the checkpoint over to the writer thread.
+    void save(Checkpoint);
+    // Interfaces to private variables.
+    int get_interval(){
+        return interval;
+    }
+    int get_written(){
+        lock_guard<mutex> lock(m);
+        return written;
+    }
+private:
+    // Writer thread body.
+    void write();
+    string file;
+    int interval;
+    unsigned common_seed;
+    // Checkpoint waiting to be written, if any.
+    unique_ptr<Checkpoint> pending;
+    // Number of checkpoints written.
+    int written;
+    bool stop;
+    mutex m;
+    condition_variable available;
+    thread writer;
+};
+
+Checkpointer::Checkpointer(const string & f, int i, unsigned seed){
+    file=f;
+    interval=max(1,i);
+    common_seed=seed;
+    written=0;
+    stop=false;
+    writer=thread(&Checkpointer::write,this);
+}
+
+Checkpointer::~Checkpointer(){
+    {
+        lock_guard<mutex> lock(m);
+        stop=true;
+    }
+    available.notify_one();
+    writer.join();
+}
+
+void Checkpointer::save(Checkpoint c){
+    c.common_seed=common_seed;
+    {
+        lock_guard<mutex> lock(m);
+        pending.reset(new Checkpoint(move(c)));
+    }
+    available.notify_one();
+}
+
+void Checkpointer::write(){
+    while(true){
+        unique_ptr<Checkpoint> c;
+        {
+            unique_lock<mutex> lock(m);
+            available.wait(lock,[this]{return stop||pending;});
+            if(!pending)
+                return;
+            c=move(pending);
+        }
+        if(!write_checkpoint(file,*c))
+            cerr << "Cannot write the checkpoint to " << file << endl;
+        lock_guard<mutex> lock(m);
+        written++;
+    }
+}
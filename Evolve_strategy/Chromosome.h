@@ -48,57 +48,75 @@ public:
     int card_index(const char &);
     // Generate index for possible sums (0-19).
     int sum_index(const int &);
+    // Value of the rank, for soft or hard hand.
+    int value(const char &, const bool &);
+    
+    // Strategy phenotype for chromosomes, the decisions the game asks
+    // the strategy for (see Engine.h):
+    
+    // If split for the given rank in pair against given dealer upcard.
+    bool split_pair(const char &, const char &);
+    // If soft dd for the given hand against given dealer upcard.
+    bool soft_double_down(const vector<char> &, const char &);
+    // If hard dd for the given hand against given dealer upcard.
+    bool hard_double_down(const vector<char> &, const char &);
+    // If hard stand for the given hand size and count against given
+    // dealer upcard; the size and the first two cards of the hand are
+    // not used by the chromosome.
+    bool hard_stand(const int &, const int &, const char &, const char &, const char &);
+    // If soft stand for the given count against given dealer upcard.
+    bool soft_stand(const int &, const char &);
     // Interfaces to private variables.
     int get_split(const int & i, const int & j){
-        return split[i][j];
+        return table_split[i][j];
     }
     int get_soft_double_down(const int & i, const int & j){
-        return soft_double_down[i][j];
+        return table_soft_double_down[i][j];
     }
     int get_hard_double_down(const int & i, const int & j){
-        return hard_double_down[i][j];
+        return table_hard_double_down[i][j];
     }
     int get_soft_stand(const int & i, const int & j){
-        return soft_stand[i][j];
+        return table_soft_stand[i][j];
     }
     int get_hard_stand(const int & i, const int & j){
-        return hard_stand[i][j];
+        return table_hard_stand[i][j];
     }
 private:
-    vector<vector<int>> split;
-    vector<vector<int>> soft_double_down;
-    vector<vector<int>> hard_double_down;
-    vector<vector<int>> soft_stand;
-    vector<vector<int>> hard_stand;
+    vector<vector<int>> table_split;
+    vector<vector<int>> table_soft_double_down;
+    vector<vector<int>> table_hard_double_down;
+    vector<vector<int>> table_soft_stand;
+    vector<vector<int>> table_hard_stand;
 };
 
 Chromosome::Chromosome(){
     // Begin by initializing the chromosome matrices to zero.
     for(int i=0;i<10;++i){
         vector<int> row(10,0);
-        split.push_back(row);
+        table_split.push_back(row);
     }
     for(int i=0;i<10;++i){
         vector<int> row(10,0);
-        soft_double_down.push_back(row);
+        table_soft_double_down.push_back(row);
     }
     for(int i=0;i<20;++i){
         vector<int> row(10,0);
-        hard_double_down.push_back(row);
+        table_hard_double_down.push_back(row);
     }
     for(int i=0;i<20;++i){
         vector<int> row(10,0);
-        soft_stand.push_back(row);
+        table_soft_stand.push_back(row);
     }
     for(int i=0;i<20;++i){
         vector<int> row(10,0);
-        hard_stand.push_back(row);
+        table_hard_stand.push_back(row);
     }
     // Fill in the chromosome matrices with random entries.
     for(int i=0;i<10;++i){
         for(int j=0;j<10;++j){
             int r=rand_index(2);
-            split[i][j]=r;
+            table_split[i][j]=r;
         }
     }
     // We cannot double down on A-T, so the last row of soft
@@ -107,45 +125,45 @@ Chromosome::Chromosome(){
     for(int i=0;i<9;++i){
         for(int j=0;j<10;++j){
             int r=rand_index(2);
-            soft_double_down[i][j]=r;
+            table_soft_double_down[i][j]=r;
         }
     }
     // this might mutate.
     for(int j=0;j<10;++j){
-        soft_double_down[9][j]=0;
+        table_soft_double_down[9][j]=0;
     }
     // Hard double down cannot be on sum=21.
     for(int i=0;i<19;++i){
         for(int j=0;j<10;++j){
             int r=rand_index(2);
-            hard_double_down[i][j]=r;
+            table_hard_double_down[i][j]=r;
         }
     }
     // this also might mutate.
     for(int j=0;j<10;++j){
-        hard_double_down[19][j]=0;
+        table_hard_double_down[19][j]=0;
     }
     // Hard stand, always stand on 21.
     for(int i=0;i<19;++i){
         for(int j=0;j<10;++j){
             int r=rand_index(2);
-            hard_stand[i][j]=r;
+            table_hard_stand[i][j]=r;
         }
     }
     // this also might mutate, but will have no phenotypic expression.
     for(int j=0;j<10;++j){
-        hard_stand[19][j]=1;
+        table_hard_stand[19][j]=1;
     }
     // Soft stand, always stand on 21.
     for(int i=0;i<19;++i){
         for(int j=0;j<10;++j){
             int r=rand_index(2);
-            soft_stand[i][j]=r;
+            table_soft_stand[i][j]=r;
         }
     }
     // this also might mutate, but will have no phenotypic expression.
     for(int j=0;j<10;++j){
-        soft_stand[19][j]=1;
+        table_soft_stand[19][j]=1;
     }
 }
 
@@ -153,23 +171,23 @@ Chromosome::Chromosome(vector<int> chrom){
     // Begin by initializing the chromosome matrices to zero.
     for(int i=0;i<10;++i){
         vector<int> row(10,0);
-        split.push_back(row);
+        table_split.push_back(row);
     }
     for(int i=0;i<10;++i){
         vector<int> row(10,0);
-        soft_double_down.push_back(row);
+        table_soft_double_down.push_back(row);
     }
     for(int i=0;i<20;++i){
         vector<int> row(10,0);
-        hard_double_down.push_back(row);
+        table_hard_double_down.push_back(row);
     }
     for(int i=0;i<20;++i){
         vector<int> row(10,0);
-        soft_stand.push_back(row);
+        table_soft_stand.push_back(row);
     }
     for(int i=0;i<20;++i){
         vector<int> row(10,0);
-        hard_stand.push_back(row);
+        table_hard_stand.push_back(row);
     }
     // Chromosome vector 'chrom' is parsed into 5 vectors, which
     // are to be flattened chromosome matrices.
@@ -187,19 +205,19 @@ Chromosome::Chromosome(vector<int> chrom){
     // De-serialize the flat vectors into chromosome matrices.
     for(int i=0;i<10;i++)
         for(int j=0;j<10;j++)
-            split[i][j]=split_flattened[10*i+j];
+            table_split[i][j]=split_flattened[10*i+j];
     for(int i=0;i<10;i++)
         for(int j=0;j<10;j++)
-            soft_double_down[i][j]=soft_double_down_flattened[10*i+j];
+            table_soft_double_down[i][j]=soft_double_down_flattened[10*i+j];
     for(int i=0;i<20;i++)
         for(int j=0;j<10;j++)
-            hard_double_down[i][j]=hard_double_down_flattened[10*i+j];
+            table_hard_double_down[i][j]=hard_double_down_flattened[10*i+j];
     for(int i=0;i<20;i++)
         for(int j=0;j<10;j++)
-            soft_stand[i][j]=soft_stand_flattened[10*i+j];
+            table_soft_stand[i][j]=soft_stand_flattened[10*i+j];
     for(int i=0;i<20;i++)
         for(int j=0;j<10;j++)
-            hard_stand[i][j]=hard_stand_flattened[10*i+j];
+            table_hard_stand[i][j]=hard_stand_flattened[10*i+j];
 }
 
 vector<int> Chromosome::flatten(){
@@ -207,27 +225,27 @@ vector<int> Chromosome::flatten(){
     vector<int> split_flatten;
     for(int i=0;i<10;++i)
         for(int j=0;j<10;++j)
-            split_flatten.push_back(split[i][j]);
+            split_flatten.push_back(table_split[i][j]);
     copy(split_flatten.begin(),split_flatten.end(),back_inserter(chrom));
     vector<int> soft_double_down_flatten;
     for(int i=0;i<10;++i)
         for(int j=0;j<10;++j)
-            soft_double_down_flatten.push_back(soft_double_down[i][j]);
+            soft_double_down_flatten.push_back(table_soft_double_down[i][j]);
     copy(soft_double_down_flatten.begin(),soft_double_down_flatten.end(),back_inserter(chrom));
     vector<int> hard_double_down_flatten;
     for(int i=0;i<20;++i)
         for(int j=0;j<10;++j)
-            hard_double_down_flatten.push_back(hard_double_down[i][j]);
+            hard_double_down_flatten.push_back(table_hard_double_down[i][j]);
     copy(hard_double_down_flatten.begin(),hard_double_down_flatten.end(),back_inserter(chrom));
     vector<int> soft_stand_flatten;
     for(int i=0;i<20;++i)
         for(int j=0;j<10;++j)
-            soft_stand_flatten.push_back(soft_stand[i][j]);
+            soft_stand_flatten.push_back(table_soft_stand[i][j]);
     copy(soft_stand_flatten.begin(),soft_stand_flatten.end(),back_inserter(chrom));
     vector<int> hard_stand_flatten;
     for(int i=0;i<20;++i)
         for(int j=0;j<10;++j)
-            hard_stand_flatten.push_back(hard_stand[i][j]);
+            hard_stand_flatten.push_back(table_hard_stand[i][j]);
     copy(hard_stand_flatten.begin(),hard_stand_flatten.end(),back_inserter(chrom));
     return chrom;
 }
@@ -340,3 +358,74 @@ int Chromosome::sum_index(const int & player_count){
     }
     return 0;
 }
+
+int Chromosome::value(const char & rank, const bool & soft){
+    if(rank=='A'&&soft)
+        return 11;
+    if(rank=='A'&&!soft)
+        return 1;
+    if(rank>='2'&&rank<='9'){
+        int v=rank-'0';
+        return v;
+    }
+    return 10;
+}
+
+bool Chromosome::split_pair(const char & player_card, const char & dealer_card){
+    int i=card_index(player_card);
+    int j=card_index(dealer_card);
+    return get_split(i,j)==1;
+}
+
+bool Chromosome::soft_double_down(const vector<char> & player_hand, const char & dealer_card){
+    // The soft hand is looked up by its card which is not the ace.
+    char player_card=player_hand[0];
+    if(player_card=='A')
+        player_card=player_hand[1];
+    if(player_card=='T')
+        return false;
+    int i=card_index(player_card);
+    int j=card_index(dealer_card);
+    return get_soft_double_down(i,j)==1;
+}
+
+bool Chromosome::hard_double_down(const vector<char> & player_hand, const char & dealer_card){
+    int val=0;
+    for(const char & c : player_hand)
+        val+=value(c,false);
+    int i=sum_index(val);
+    int j=card_index(dealer_card);
+    return get_hard_double_down(i,j)==1;
+}
+
+bool Chromosome::hard_stand(const int & player_hand_size, const int & player_count,
+                            const char & dealer_card, const char & player_1,
+                            const char & player_2){
+    int i=sum_index(player_count);
+    int j=card_index(dealer_card);
+    return get_hard_stand(i,j)==1;
+}
+
+bool Chromosome::soft_stand(const int & player_count, const char & dealer_card){
+    int i=sum_index(player_count);
+    int j=card_index(dealer_card);
+    return get_soft_stand(i,j)==1;
+}
+
+// Packs the flattened chromosome of 0 and 1 into bits, gene 'k' being
+// the bit k%8 of the byte k/8, so 800 genes take 100 bytes.
+void pack_chromosome(const vector<int> & chrom, unsigned char * packed){
+    for(int k=0;k<(chrom.size()+7)/8;++k)
+        packed[k]=0;
+    for(int k=0;k<chrom.size();++k)
+        if(chrom[k]==1)
+            packed[k/8]|=(1<<(k%8));
+}
+
+// Unpacks the given number of genes, 800 by default.
+vector<int> unpack_chromosome(const unsigned char * packed, const int & genes=800){
+    vector<int> chrom(genes);
+    for(int k=0;k<genes;++k)
+        chrom[k]=(packed[k/8]>>(k%8))&1;
+    return chrom;
+}
@@ -0,0 +1,312 @@
+/**
+
+ ControlVariateEvaluator is the Evaluator which plays the population on
+ the shared deal (see SharedDeal.h and SharedDealEvaluator.h) together
+ with a reference strategy of known edge, such as the Thorp's basic
+ strategy of create_strategy_chromosome.cpp, and uses the reference as a
+ control variate of the fit scores.
+
+ The reference plays the same rounds as every strategy of the group, so
+ most of the luck of the cards is the same for both of them. For each
+ strategy the net results of the rounds it played, x, and those of the
+ reference on the same rounds, y, give the optimal scale
+
+   beta = Cov(x,y)/Var(y),
+
+ and the final bankroll of the strategy is corrected by beta times the
+ difference between what the reference won over these rounds and what it
+ was expected to win at its known edge. The corrected bankroll has the
+ same mean as the played one, and its variance is smaller by the factor
+ 1-rho^2, rho being the correlation of x and y; a strategy close to the
+ reference is then ranked as well as it would be with 1/(1-rho^2) times
+ the rounds. The fit score is the corrected bankroll divided by the
+ initial one, zero if the player went bankrupt, as in Evaluator.h.
+
+ The edge of the reference (its mean net result per round, in bets) is
+ either given, or measured by calibrate() over many rounds played the
+ same way as the evaluation (the same shoe bank and the same dealer's
+ sampler). An error in the edge shifts the fit scores of all strategies
+ which played all their rounds by the same amount, which doesn't change
+ their order.
+
+ The ratio of the variance of the corrected results to that of the
+ played ones, summed over the strategies of each generation, is kept for
+ every generation, see report().
+
+ */
+
+using namespace std;
+
+class ControlVariateEvaluator : public Evaluator{
+public:
+    // Constructor takes the pool, the common seed (zero meaning a new
+    // random seed for each generation), the number of strategies K which
+    // share the deal, the 800 genes of the reference strategy and its
+    // edge per round in bets.
+    ControlVariateEvaluator(ThreadPool &, unsigned, int, const vector<int> &, const double & =0);
+    // Fit scores of the population, played on the pool.
+    vector<double> evaluate(vector<Game> &, const int &, const int &);
+    // Measure the edge of the reference over the given number of rounds
+    // on the pool, and use it from then on. Returns the edge.
+    double calibrate(const long long &);
+    // Print the edge of the reference and the mean variance ratio over
+    // the generations.
+    void report(ostream &);
+    // Play the shoes of the given bank, nullptr to shuffle again. The bank
+    // must outlive the evaluator.
+    void set_shoe_bank(ShoeBank * b){
+        bank=b;
+    }
+    // Sample the dealer's outcome from the given sampler instead of
+    // drawing the dealer's cards (see SharedDeal.h), nullptr to draw them.
+    // The sampler must outlive the evaluator.
+    void set_dealer_sampler(const DealerSampler * s){
+        sampler=s;
+    }
+    // Continue the seeds after the given number of evaluations, used when
+    // the run is resumed from a checkpoint.
+    void set_generation(const int & g){
+        generation=g;
+    }
+    // Interfaces to private variables.
+    double get_edge(){
+        return edge;
+    }
+    double get_edge_error(){
+        return edge_error;
+    }
+    vector<double> get_variance_ratios(){
+        return variance_ratios;
+    }
+    vector<double> get_betas(){
+        return betas;
+    }
+private:
+    ThreadPool & pool;
+    int client;
+    unsigned common_seed;
+    int K;
+    int generation;
+    ShoeBank * bank;
+    const DealerSampler * sampler;
+    vector<int> reference;
+    // Edge of the reference per round in bets, and its standard error if
+    // it was measured.
+    double edge;
+    double edge_error;
+    // Variance of the corrected results over that of the played ones, and
+    // the mean beta, for each generation.
+    vector<double> variance_ratios;
+    vector<double> betas;
+};
+
+// Sums of the net results of a strategy (x) and of the reference (y) over
+// the rounds the strategy played.
+struct PairedSums{
+    PairedSums(){
+        n=0;
+        x=0;
+        y=0;
+        xx=0;
+        xy=0;
+        yy=0;
+    }
+    void add(const double & a, const double & b){
+        ++n;
+        x+=a;
+        y+=b;
+        xx+=a*a;
+        xy+=a*b;
+        yy+=b*b;
+    }
+    long long n;
+    double x;
+    double y;
+    double xx;
+    double xy;
+    double yy;
+};
+
+ControlVariateEvaluator::ControlVariateEvaluator(ThreadPool & tp, unsigned seed, int k,
+                                                 const vector<int> & ref, const double & e) : pool(tp){
+    client=pool.add_client();
+    common_seed=seed;
+    K=k;
+    generation=0;
+    bank=nullptr;
+    sampler=nullptr;
+    reference=ref;
+    edge=e;
+    edge_error=0;
+}
+
+// Large enough bankrolls that the reference never stops playing.
+const int REFERENCE_BANKROLL=1<<30;
+
+vector<double> ControlVariateEvaluator::evaluate(vector<Game> & population, const int & R, const int & p){
+    unsigned deal_seed=rand();
+    if(common_seed!=0){
+        seed_seq seq{common_seed,(unsigned) generation};
+        seq.generate(&deal_seed,&deal_seed+1);
+    }
+    generation++;
+    const unsigned char * shoes=nullptr;
+    unsigned long long count=R;
+    if(bank!=nullptr)
+        shoes=bank->shoes(deal_seed,count);
+    int cards=(bank!=nullptr) ? bank->cards() : 0;
+    int M=population.size();
+    int group=K>0 ? K : (M+pool.get_workers()-1)/pool.get_workers();
+    group=max(1,group);
+    vector<int> bankrolls(M);
+    vector<PairedSums> sums(M);
+    vector<function<void()>> tasks;
+    for(int first=0;first<M;first+=group){
+        int last=min(M,first+group);
+        const DealerSampler * dealer_sampler=sampler;
+        const vector<int> * ref=&reference;
+        tasks.push_back([&population,&bankrolls,&sums,first,last,deal_seed,shoes,cards,count,
+                         dealer_sampler,ref,R]{
+            vector<SharedPlayer> players;
+            for(int i=first;i<last;++i){
+                Game & game=population[i];
+                players.push_back(SharedPlayer(game.flatten(),game.get_player_bankroll(),
+                                               game.get_dealer_bankroll(),game.get_bet_size()));
+            }
+            int bet=population[first].get_bet_size();
+            SharedPlayer reference_player(*ref,REFERENCE_BANKROLL,REFERENCE_BANKROLL,bet);
+            SharedDeal deal=(shoes!=nullptr) ? SharedDeal(shoes,cards,count,deal_seed) :
+                SharedDeal(deal_seed);
+            deal.set_dealer_sampler(dealer_sampler);
+            for(int round=0;round<R;++round){
+                bool active=false;
+                for(SharedPlayer & player : players)
+                    active=active||player.active();
+                if(!active)
+                    break;
+                deal.next();
+                int before=reference_player.get_player_bankroll();
+                reference_player.play_round(deal);
+                double y=reference_player.get_player_bankroll()-before;
+                for(int i=first;i<last;++i){
+                    SharedPlayer & player=players[i-first];
+                    if(!player.active())
+                        continue;
+                    before=player.get_player_bankroll();
+                    player.play_round(deal);
+                    sums[i].add(player.get_player_bankroll()-before,y);
+                }
+            }
+            for(int i=first;i<last;++i)
+                bankrolls[i]=players[i-first].get_player_bankroll();
+        });
+    }
+    pool.run(client,tasks);
+    vector<double> scores(M);
+    double played=0;
+    double corrected=0;
+    double beta_sum=0;
+    int counted=0;
+    for(int i=0;i<M;++i){
+        PairedSums & s=sums[i];
+        double beta=0;
+        double var_x=0;
+        double var_y=0;
+        double cov=0;
+        if(s.n>1){
+            var_x=s.xx-s.x*s.x/s.n;
+            var_y=s.yy-s.y*s.y/s.n;
+            cov=s.xy-s.x*s.y/s.n;
+            if(var_y>0)
+                beta=cov/var_y;
+            played+=var_x;
+            corrected+=var_x-beta*cov;
+            beta_sum+=beta;
+            ++counted;
+        }
+        if(bankrolls[i]<=0){
+            scores[i]=0;
+            continue;
+        }
+        double bet=population[i].get_bet_size();
+        double expected=s.n*edge*bet;
+        double final_bankroll=bankrolls[i]-beta*(s.y-expected);
+        scores[i]=max(0.0,final_bankroll)/p;
+    }
+    variance_ratios.push_back(played>0 ? corrected/played : 1);
+    betas.push_back(counted>0 ? beta_sum/counted : 0);
+    return scores;
+}
+
+double ControlVariateEvaluator::calibrate(const long long & rounds){
+    const long long chunk=1000000;
+    long long chunks=(rounds+chunk-1)/chunk;
+    unsigned seed=(common_seed!=0) ? common_seed : rand();
+    vector<double> net(chunks);
+    vector<double> squares(chunks);
+    vector<function<void()>> tasks;
+    for(long long c=0;c<chunks;++c){
+        long long R=min(chunk,rounds-c*chunk);
+        // Seeds of the chunks, apart from the seeds of the generations.
+        unsigned chunk_seed;
+        seed_seq seq{seed,(unsigned) c,1u};
+        seq.generate(&chunk_seed,&chunk_seed+1);
+        const unsigned char * shoes=nullptr;
+        unsigned long long count=R;
+        if(bank!=nullptr)
+            shoes=bank->shoes(chunk_seed,count);
+        int cards=(bank!=nullptr) ? bank->cards() : 0;
+        const DealerSampler * dealer_sampler=sampler;
+        const vector<int> * ref=&reference;
+        tasks.push_back([&net,&squares,c,R,chunk_seed,shoes,cards,count,dealer_sampler,ref]{
+            // With the bet of one the natural's 1.5 would be rounded down,
+            // so the reference is played with the bet of two.
+            SharedPlayer player(*ref,REFERENCE_BANKROLL,REFERENCE_BANKROLL,2);
+            SharedDeal deal=(shoes!=nullptr) ? SharedDeal(shoes,cards,count,chunk_seed) :
+                SharedDeal(chunk_seed);
+            deal.set_dealer_sampler(dealer_sampler);
+            double s=0;
+            double ss=0;
+            for(long long round=0;round<R;++round){
+                int before=player.get_player_bankroll();
+                deal.next();
+                player.play_round(deal);
+                double x=(player.get_player_bankroll()-before)/2.0;
+                s+=x;
+                ss+=x*x;
+            }
+            net[c]=s;
+            squares[c]=ss;
+        });
+    }
+    pool.run(client,tasks);
+    double s=0;
+    double ss=0;
+    for(long long c=0;c<chunks;++c){
+        s+=net[c];
+        ss+=squares[c];
+    }
+    edge=(rounds>0) ? s/rounds : 0;
+    edge_error=(rounds>1) ? sqrt((ss/rounds-edge*edge)/(rounds-1)) : 0;
+    return edge;
+}
+
+void ControlVariateEvaluator::report(ostream & os){
+    os << "reference edge " << edge;
+    if(edge_error>0)
+        os << " +- " << edge_error;
+    os << " per round in bets" << endl;
+    if(variance_ratios.empty())
+        return;
+    double ratio=0;
+    double beta=0;
+    for(int g=0;g<variance_ratios.size();++g){
+        ratio+=variance_ratios[g];
+        beta+=betas[g];
+    }
+    ratio/=variance_ratios.size();
+    beta/=betas.size();
+    os << "control variate left " << 100*ratio << "% of the variance of the fit scores (mean beta "
+       << beta << "), the same accuracy would take " << (ratio>0 ? 1/ratio : 0)
+       << " times the rounds without it" << endl;
+}
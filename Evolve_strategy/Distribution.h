@@ -0,0 +1,220 @@
+/**
+
+ Distribution evolves the strategy as an estimation-of-distribution
+ model (population-based incremental learning). Instead of keeping a
+ population of Game objects it keeps only the probability vector with
+ 800 entries, of the same kind as produced by Evolve::mean_strategy(),
+ where entry k is the probability that gene k of a chromosome is 1.
+
+ Each generation N chromosomes are sampled from the probability vector
+ and each of them plays R rounds, exactly as in Evolve::update_fit_scores().
+ The 'select' most fit samples are averaged with the weights proportional
+ to their fit scores, and the probability vector is shifted towards
+ that mean by the learning rate:
+
+ prob -> (1-learning_rate)*prob + learning_rate*elite_mean
+
+ The propagation rate plays the role of mutation: the probability vector
+ is kept within [1-propagate, propagate], so that no gene is ever fixed.
+
+ Sampling and playing is done by worker threads, which pull sample indexes
+ from a shared counter. Sample 'i' of a generation is drawn from its own
+ random engine seeded by the generation seed and 'i', so that each worker
+ only remembers the indexes and the fit scores of its 'select' most fit
+ samples, and the elite chromosomes are re-drawn at the end of the
+ generation. The memory used is therefore independent of N.
+
+ */
+
+using namespace std;
+
+class Distribution{
+public:
+    // Constructor takes as an argument initial bankrolls for player
+    // and dealer, bet size, propagation rate, selection rate, number
+    // of samples per generation, number of rounds played, learning
+    // rate and number of worker threads. The probability vector is
+    // initialized to 1/2, same as the random Chromosome.
+    Distribution(int, int, int, double, double, int, int, double, int);
+    // Constructor which also initializes the probability vector.
+    Distribution(int, int, int, double, double, int, int, double, int,
+                 vector<double>);
+    // Draw the sample chromosome 'i' for the given generation seed.
+    vector<int> sample(const unsigned &, const int &);
+    // Sample, play and update the probability vector. Returns the mean
+    // score of the 'select' most fit samples.
+    double new_generation();
+    // Evolve over given number of steps.
+    void evolve(const int &);
+    // Save the probability vector to the file, in the chrom.csv format.
+    void save(const string &);
+    // Interfaces to private variables.
+    vector<double> get_prob(){
+        return prob;
+    }
+    vector<double> get_score_time_series(){
+        return score_time_series;
+    }
+private:
+    // Worker thread body: plays samples with indexes pulled from 'next',
+    // and keeps the 'select' most fit as (fit score, index) pairs.
+    void work(const unsigned &, atomic<int> &, vector<pair<double,int>> &);
+    // Keep the probability vector within [1-propagate, propagate].
+    void bound();
+    // Initial player's bankroll.
+    int p;
+    // Initial dealer's bankroll.
+    int d;
+    // Bet size.
+    int b;
+    // Propagation rate, bounds the probability vector.
+    double propagate;
+    // Selection rate, the fraction of the most fit samples which the
+    // probability vector is shifted towards.
+    double selection_rate;
+    // Number of samples per generation.
+    int N;
+    // Number of rounds played used to calculate fit scores.
+    int R;
+    // Rate at which the probability vector moves towards the elite mean.
+    double learning_rate;
+    // Number of worker threads.
+    int workers;
+    // Probability of each gene to be 1.
+    vector<double> prob;
+    // Time series of the mean elite scores.
+    vector<double> score_time_series;
+};
+
+Distribution::Distribution(int P, int D, int B, double prop, double sel_rate,
+                           int n, int r, double rate, int w){
+    p=P;
+    d=D;
+    b=B;
+    propagate=prop;
+    selection_rate=sel_rate;
+    N=n;
+    R=r;
+    learning_rate=rate;
+    workers=max(1,w);
+    prob=vector<double>(800,0.5);
+}
+
+Distribution::Distribution(int P, int D, int B, double prop, double sel_rate,
+                           int n, int r, double rate, int w, vector<double> pr){
+    p=P;
+    d=D;
+    b=B;
+    propagate=prop;
+    selection_rate=sel_rate;
+    N=n;
+    R=r;
+    learning_rate=rate;
+    workers=max(1,w);
+    prob=pr;
+    bound();
+}
+
+vector<int> Distribution::sample(const unsigned & seed, const int & i){
+    seed_seq seq{seed,(unsigned) i};
+    mt19937 engine(seq);
+    uniform_real_distribution<double> uniform(0.0,1.0);
+    vector<int> chrom(prob.size());
+    for(int k=0;k<prob.size();++k)
+        chrom[k]=(uniform(engine)<prob[k]) ? 1 : 0;
+    return chrom;
+}
+
+void Distribution::work(const unsigned & seed, atomic<int> & next,
+                        vector<pair<double,int>> & elite){
+    int select=max(1,int(selection_rate*N));
+    // 'elite' is kept as a min-heap, so that the least fit of the
+    // elite is at the front and is the one to be replaced.
+    auto fitter=[](const pair<double,int> & x, const pair<double,int> & y){
+        return x.first>y.first;
+    };
+    while(true){
+        int i=next++;
+        if(i>=N)
+            break;
+        Game game(p,d,b,sample(seed,i));
+        game.play(R);
+        double score=0;
+        // Bankrupt strategies have zero fit score.
+        if(game.get_player_bankroll()>0)
+            score=double(game.get_player_bankroll())/p;
+        if(elite.size()<select){
+            elite.push_back(make_pair(score,i));
+            push_heap(elite.begin(),elite.end(),fitter);
+        }
+        else if(score>elite.front().first){
+            pop_heap(elite.begin(),elite.end(),fitter);
+            elite.back()=make_pair(score,i);
+            push_heap(elite.begin(),elite.end(),fitter);
+        }
+    }
+}
+
+double Distribution::new_generation(){
+    unsigned seed=rand();
+    int select=max(1,int(selection_rate*N));
+    atomic<int> next(0);
+    vector<vector<pair<double,int>>> elites(workers);
+    vector<thread> threads;
+    for(int w=0;w<workers;++w)
+        threads.push_back(thread(&Distribution::work,this,seed,ref(next),ref(elites[w])));
+    for(thread & t : threads)
+        t.join();
+    // Merge the elites of all workers and keep the 'select' most fit.
+    vector<pair<double,int>> elite;
+    for(const vector<pair<double,int>> & e : elites)
+        copy(e.begin(),e.end(),back_inserter(elite));
+    sort(elite.begin(),elite.end(),
+         [](const pair<double,int> & x, const pair<double,int> & y){
+             return x.first>y.first||(x.first==y.first&&x.second<y.second);
+         });
+    if(elite.size()>select)
+        elite.resize(select);
+    double tot_fit=0;
+    for(const pair<double,int> & e : elite)
+        tot_fit+=e.first;
+    // Fitness weighted mean of the elite chromosomes, same as in
+    // Evolve::mean_strategy(). If all of the elite went bankrupt
+    // they are weighted equally.
+    vector<double> elite_mean(prob.size(),0);
+    for(const pair<double,int> & e : elite){
+        double w=(tot_fit>0) ? e.first/tot_fit : 1.0/elite.size();
+        vector<int> chrom=sample(seed,e.second);
+        for(int k=0;k<chrom.size();++k)
+            elite_mean[k]+=w*chrom[k];
+    }
+    for(int k=0;k<prob.size();++k)
+        prob[k]=(1-learning_rate)*prob[k]+learning_rate*elite_mean[k];
+    bound();
+    return tot_fit/elite.size();
+}
+
+void Distribution::evolve(const int & generations){
+    for(int i=0;i<generations;++i){
+        double mean_fit=new_generation();
+        cout << "fit for generation " << i << " is " << mean_fit << endl;
+        score_time_series.push_back(mean_fit);
+    }
+}
+
+void Distribution::bound(){
+    for(double & pk : prob){
+        pk=min(pk,propagate);
+        pk=max(pk,1-propagate);
+    }
+}
+
+void Distribution::save(const string & file){
+    ofstream file_chromosome(file);
+    int vsize=prob.size()-1;
+    for(int n=0;n<vsize;n++){
+        file_chromosome << prob[n];
+        file_chromosome << ",";
+    }
+    file_chromosome << prob[vsize];
+}
@@ -0,0 +1,33 @@
+/**
+
+ Evaluator calculates the fit scores of the population of Games for
+ Evolve::update_fit_scores(). Without an Evaluator the Evolve class
+ plays the Games one after another in its own thread; the classes
+ derived from the Evaluator play them elsewhere, for instance in the
+ worker processes (see Workers.h).
+
+ The fit score of a strategy is the final bankroll after R rounds of
+ game divided by the initial bankroll, and zero if the player went
+ bankrupt.
+
+ */
+
+using namespace std;
+
+// Plays R rounds on the copy of the given Game and returns its fit score,
+// for the given initial player's bankroll.
+double fit_score(Game game, const int & R, const int & p){
+    game.play(R);
+    if(game.get_player_bankroll()<=0)
+        return 0;
+    double final_bankroll=game.get_player_bankroll();
+    return final_bankroll/p;
+}
+
+class Evaluator{
+public:
+    virtual ~Evaluator(){}
+    // Fit scores of the population, each Game playing R rounds,
+    // for the given initial player's bankroll.
+    virtual vector<double> evaluate(vector<Game> &, const int &, const int &)=0;
+};
@@ -0,0 +1,347 @@
+/**
+
+ HistoryLog writes the population of every generation of Evolve, with
+ the fit scores and the parents of each strategy, to an append-only
+ binary log (history.bin), so that the convergence can be studied after
+ the run. HistoryReader reads it back (see also read_history.py).
+
+ The log is in the native (little-endian) byte order:
+
+ * 16 byte header: uint32 magic 0x4c484a42 ("BJHL"), uint32 version 1,
+   uint32 bytes per strategy (100), uint32 keyframe interval K,
+ * one record per generation, each starting at a multiple of 8 bytes:
+   - uint32 generation, uint32 number of strategies M, uint32 keyframe
+     flag, uint32 size of the strategies block in bytes,
+   - M float64 fit scores,
+   - M int32 first parents and M int32 second parents, the indexes of
+     the parents in the previous generation; a strategy which was passed
+     on without breeding has the second parent -1, and the strategies of
+     the first generation logged have both parents -1,
+   - the strategies block, padded with zeros to a multiple of 8 bytes.
+     Each strategy starts with a byte 0 followed by the 100 bytes packed
+     by pack_chromosome(), or with a byte 1 followed by a byte 'n' and 'n'
+     pairs of bytes (position, xor) which turn the packed first parent
+     into the strategy. The shorter of the two is written, and every K-th
+     record (a keyframe) has all strategies written in full,
+ * the index, written when the log is closed: uint64 offset of each
+   record, uint64 number of records, uint32 magic 0x58494a42 ("BJIX"),
+   uint32 0.
+
+ With the index any record is found at once, and its fit scores and
+ parents are read in place. Its strategies are decoded starting from the
+ last keyframe, so from at most K records. If the run crashed before the
+ index was written, the records are found by going through the log.
+
+ The records are encoded and written by a separate thread through a
+ large buffer, so that logging a generation costs the evolution only a
+ copy of the packed population.
+
+ */
+
+using namespace std;
+
+const unsigned HISTORY_MAGIC=0x4c484a42;
+const unsigned HISTORY_INDEX_MAGIC=0x58494a42;
+const unsigned HISTORY_VERSION=1;
+
+class HistoryLog{
+public:
+    // Constructor takes the log file and the keyframe interval.
+    HistoryLog(const string &, int);
+    // Writes the remaining records and the index, and closes the log.
+    ~HistoryLog();
+    // Hand the generation over to the writer thread: its number, the
+    // population, the fit scores and the parents.
+    void log(const int &, vector<Game> &, const vector<double> &,
+             const vector<pair<int,int>> &);
+private:
+    struct Record{
+        int generation;
+        vector<unsigned char> packed;
+        vector<double> fit_scores;
+        vector<pair<int,int>> parents;
+    };
+    // Writer thread body.
+    void write();
+    // Encode and write one record.
+    void write_record(const Record &);
+    ofstream os;
+    // Buffer of the output stream.
+    vector<char> buffer;
+    int keyframe_interval;
+    // Offsets of the records written, and the packed population of the
+    // last record, which the next one is encoded against.
+    vector<unsigned long long> offsets;
+    vector<unsigned char> previous;
+    unsigned long long position;
+    // Records waiting to be written.
+    deque<Record> queue;
+    bool stop;
+    mutex m;
+    condition_variable available;
+    thread writer;
+};
+
+HistoryLog::HistoryLog(const string & file, int k){
+    buffer=vector<char>(1<<20);
+    os.rdbuf()->pubsetbuf(buffer.data(),buffer.size());
+    os.open(file,ios::binary);
+    keyframe_interval=max(1,k);
+    unsigned header[4]={HISTORY_MAGIC,HISTORY_VERSION,100,(unsigned) keyframe_interval};
+    os.write((const char *) header,sizeof(header));
+    position=sizeof(header);
+    stop=false;
+    writer=thread(&HistoryLog::write,this);
+}
+
+HistoryLog::~HistoryLog(){
+    {
+        lock_guard<mutex> lock(m);
+        stop=true;
+    }
+    available.notify_one();
+    writer.join();
+    unsigned long long n=offsets.size();
+    unsigned trailer[2]={HISTORY_INDEX_MAGIC,0};
+    os.write((const char *) offsets.data(),8*n);
+    os.write((const char *) &n,8);
+    os.write((const char *) trailer,sizeof(trailer));
+    os.close();
+}
+
+void HistoryLog::log(const int & generation, vector<Game> & population,
+                     const vector<double> & fit_scores,
+                     const vector<pair<int,int>> & parents){
+    Record record;
+    record.generation=generation;
+    record.packed=vector<unsigned char>(100*population.size());
+    for(int i=0;i<population.size();++i)
+        pack_chromosome(population[i].flatten(),&record.packed[100*i]);
+    record.fit_scores=fit_scores;
+    record.parents=parents;
+    {
+        lock_guard<mutex> lock(m);
+        queue.push_back(move(record));
+    }
+    available.notify_one();
+}
+
+void HistoryLog::write(){
+    while(true){
+        Record record;
+        {
+            unique_lock<mutex> lock(m);
+            available.wait(lock,[this]{return stop||!queue.empty();});
+            if(queue.empty())
+                return;
+            record=move(queue.front());
+            queue.pop_front();
+        }
+        write_record(record);
+    }
+}
+
+void HistoryLog::write_record(const Record & record){
+    unsigned M=record.fit_scores.size();
+    bool keyframe=offsets.size()%keyframe_interval==0;
+    vector<unsigned char> block;
+    for(int i=0;i<M;++i){
+        const unsigned char * g=&record.packed[100*i];
+        int parent=record.parents[i].first;
+        // Positions where the strategy differs from its first parent.
+        vector<unsigned char> delta;
+        if(!keyframe&&parent>=0&&100*parent<previous.size()){
+            const unsigned char * f=&previous[100*parent];
+            for(int k=0;k<100&&delta.size()<100;++k)
+                if(g[k]!=f[k]){
+                    delta.push_back(k);
+                    delta.push_back(g[k]^f[k]);
+                }
+        }
+        if(!keyframe&&parent>=0&&100*parent<previous.size()&&delta.size()+2<101){
+            block.push_back(1);
+            block.push_back(delta.size()/2);
+            block.insert(block.end(),delta.begin(),delta.end());
+        }
+        else{
+            block.push_back(0);
+            block.insert(block.end(),g,g+100);
+        }
+    }
+    while(block.size()%8!=0)
+        block.push_back(0);
+    unsigned header[4]={(unsigned) record.generation,M,keyframe ? 1u : 0u,
+                        (unsigned) block.size()};
+    vector<int> first(M);
+    vector<int> second(M);
+    for(int i=0;i<M;++i){
+        first[i]=record.parents[i].first;
+        second[i]=record.parents[i].second;
+    }
+    offsets.push_back(position);
+    os.write((const char *) header,sizeof(header));
+    os.write((const char *) record.fit_scores.data(),8*M);
+    os.write((const char *) first.data(),4*M);
+    os.write((const char *) second.data(),4*M);
+    os.write((const char *) block.data(),block.size());
+    position+=sizeof(header)+16*M+block.size();
+    previous=record.packed;
+}
+
+class HistoryReader{
+public:
+    // Constructor takes the log file. On Linux it is mapped into memory.
+    HistoryReader(const string &);
+    ~HistoryReader();
+    // Number of records.
+    int size(){
+        return offsets.size();
+    }
+    // Generation, fit scores, and parents of the record 'k'.
+    int get_generation(const int &);
+    vector<double> get_fit_scores(const int &);
+    vector<pair<int,int>> get_parents(const int &);
+    // Population of the record 'k', decoded from the last keyframe.
+    vector<vector<int>> get_population(const int &);
+private:
+    // Packed population of the record 'k', given the packed population
+    // of the record before it.
+    vector<unsigned char> decode(const int &, const vector<unsigned char> &);
+    const char * data;
+    size_t length;
+    vector<char> buffer;
+    bool mapped;
+    vector<unsigned long long> offsets;
+};
+
+HistoryReader::HistoryReader(const string & file){
+    data=nullptr;
+    length=0;
+    mapped=false;
+#ifdef __linux__
+    int fd=open(file.c_str(),O_RDONLY);
+    struct stat st;
+    if(fd>=0&&fstat(fd,&st)==0&&st.st_size>0){
+        void * p=mmap(nullptr,st.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+        if(p!=MAP_FAILED){
+            data=(const char *) p;
+            length=st.st_size;
+            mapped=true;
+        }
+    }
+    if(fd>=0)
+        close(fd);
+#endif
+    if(!mapped){
+        ifstream is(file,ios::binary);
+        buffer.assign(istreambuf_iterator<char>(is),istreambuf_iterator<char>());
+        data=buffer.data();
+        length=buffer.size();
+    }
+    unsigned header[4]={0,0,0,0};
+    if(length>=16)
+        memcpy(header,data,16);
+    if(header[0]!=HISTORY_MAGIC||header[1]!=HISTORY_VERSION){
+        cerr << "Not a history log: " << file << endl;
+        return;
+    }
+    // Use the index if it is there, otherwise go through the records.
+    unsigned trailer[2]={0,0};
+    unsigned long long n=0;
+    if(length>=32){
+        memcpy(trailer,data+length-8,8);
+        memcpy(&n,data+length-16,8);
+    }
+    if(trailer[0]==HISTORY_INDEX_MAGIC&&16+8*n+16<=length){
+        const char * index=data+length-16-8*n;
+        offsets=vector<unsigned long long>(n);
+        memcpy(offsets.data(),index,8*n);
+        return;
+    }
+    unsigned long long at=16;
+    while(at+16<=length){
+        unsigned record[4];
+        memcpy(record,data+at,16);
+        unsigned long long next=at+16+16ULL*record[1]+record[3];
+        if(next>length)
+            break;
+        offsets.push_back(at);
+        at=next;
+    }
+}
+
+HistoryReader::~HistoryReader(){
+#ifdef __linux__
+    if(mapped)
+        munmap((void *) data,length);
+#endif
+}
+
+int HistoryReader::get_generation(const int & k){
+    unsigned record[4];
+    memcpy(record,data+offsets[k],16);
+    return record[0];
+}
+
+vector<double> HistoryReader::get_fit_scores(const int & k){
+    unsigned record[4];
+    memcpy(record,data+offsets[k],16);
+    vector<double> ret(record[1]);
+    memcpy(ret.data(),data+offsets[k]+16,8*record[1]);
+    return ret;
+}
+
+vector<pair<int,int>> HistoryReader::get_parents(const int & k){
+    unsigned record[4];
+    memcpy(record,data+offsets[k],16);
+    int M=record[1];
+    vector<int> first(M);
+    vector<int> second(M);
+    memcpy(first.data(),data+offsets[k]+16+8*M,4*M);
+    memcpy(second.data(),data+offsets[k]+16+12*M,4*M);
+    vector<pair<int,int>> ret;
+    for(int i=0;i<M;++i)
+        ret.push_back(make_pair(first[i],second[i]));
+    return ret;
+}
+
+vector<unsigned char> HistoryReader::decode(const int & k, const vector<unsigned char> & previous){
+    unsigned record[4];
+    memcpy(record,data+offsets[k],16);
+    int M=record[1];
+    vector<pair<int,int>> parents=get_parents(k);
+    const unsigned char * at=(const unsigned char *) data+offsets[k]+16+16*M;
+    vector<unsigned char> packed(100*M);
+    for(int i=0;i<M;++i){
+        if(*at++==0){
+            memcpy(&packed[100*i],at,100);
+            at+=100;
+            continue;
+        }
+        int n=*at++;
+        memcpy(&packed[100*i],&previous[100*parents[i].first],100);
+        for(int j=0;j<n;++j){
+            packed[100*i+at[0]]^=at[1];
+            at+=2;
+        }
+    }
+    return packed;
+}
+
+vector<vector<int>> HistoryReader::get_population(const int & k){
+    int start=k;
+    while(start>0){
+        unsigned record[4];
+        memcpy(record,data+offsets[start],16);
+        if(record[2]==1)
+            break;
+        start--;
+    }
+    vector<unsigned char> packed;
+    for(int j=start;j<=k;++j)
+        packed=decode(j,packed);
+    vector<vector<int>> ret;
+    for(int i=0;i<packed.size()/100;++i)
+        ret.push_back(unpack_chromosome(&packed[100*i]));
+    return ret;
+}
@@ -0,0 +1,296 @@
+/**
+
+ Islands evolves K independent populations (islands), each one being an
+ Evolve object with its own propagation and selection rates, on its own
+ thread pinned to its own group of cores. The islands do not wait for
+ each other: each island runs its generations at its own pace.
+
+ Every 'interval' generations each island sends copies of its 'migrants'
+ most fit strategies, with their fit scores, to the next island in the
+ ring (island k sends to island k+1, the last one sends to the first).
+ Migrants travel through the Mailbox, a lock-free ring buffer with a
+ single sender and a single receiver. An island picks up the migrants
+ which have arrived at the start of each generation, and they replace
+ its least fit strategies. If the mailbox is full the migrants are
+ dropped rather than making the sender wait.
+
+ The most fit strategies sent by the islands, and the most fit strategies
+ of each island at the end of the evolution, are collected in the global
+ elite archive. At the end the archive is saved to elite.csv, one strategy
+ per line, with its fit score as the first entry. The fitness-weighted mean
+ of the archive is saved to chrom.csv, in the same format as the mean
+ strategy saved by Evolve::mean_strategy(). The time series of the mean
+ of the island scores is saved as the first line of scores.csv, followed
+ by the score time series of each island.
+
+ */
+
+using namespace std;
+
+class Mailbox{
+public:
+    // Constructor takes the number of migrants the mailbox can hold.
+    Mailbox(int);
+    // Called by the sender only. Returns false if the mailbox is full.
+    bool send(const pair<vector<int>,double> &);
+    // Called by the receiver only. Returns false if the mailbox is empty.
+    bool receive(pair<vector<int>,double> &);
+private:
+    vector<pair<vector<int>,double>> slots;
+    // Index of the next slot to receive from, moved by the receiver.
+    atomic<int> head;
+    // Index of the next slot to send to, moved by the sender.
+    atomic<int> tail;
+};
+
+Mailbox::Mailbox(int capacity) : slots(capacity+1), head(0), tail(0){
+}
+
+bool Mailbox::send(const pair<vector<int>,double> & migrant){
+    int t=tail.load(memory_order_relaxed);
+    int next=(t+1)%slots.size();
+    if(next==head.load(memory_order_acquire))
+        return false;
+    slots[t]=migrant;
+    tail.store(next,memory_order_release);
+    return true;
+}
+
+bool Mailbox::receive(pair<vector<int>,double> & migrant){
+    int h=head.load(memory_order_relaxed);
+    if(h==tail.load(memory_order_acquire))
+        return false;
+    migrant=slots[h];
+    head.store((h+1)%slots.size(),memory_order_release);
+    return true;
+}
+
+class Islands{
+public:
+    // Constructor takes as an argument initial bankrolls for player
+    // and dealer, bet size, propagation rate and selection rate for
+    // each island, size of the population of each island, number of
+    // rounds played, number of generations between migrations, number
+    // of migrants and size of the elite archive. The islands are
+    // initialized randomly.
+    Islands(int, int, int, vector<double>, vector<double>, int, int,
+            int, int, int);
+    // Constructor which also initializes all members of all islands
+    // to the given strategy.
+    Islands(int, int, int, vector<double>, vector<double>, int, int,
+            int, int, int, vector<int>);
+    // Evolve all islands over the given number of generations.
+    void evolve(const int &);
+    // Save elite.csv, chrom.csv and scores.csv.
+    void save();
+    // Interfaces to private variables.
+    vector<pair<vector<int>,double>> get_archive(){
+        return archive;
+    }
+    vector<vector<double>> get_score_time_series(){
+        return score_time_series;
+    }
+private:
+    // Thread body evolving island 'k'.
+    void run_island(const int &, const int &);
+    // Pin the thread of island 'k' to its group of cores.
+    void pin(thread &, const int &);
+    // Add the strategies to the elite archive.
+    void add_to_archive(const vector<pair<vector<int>,double>> &);
+    // Initial player's bankroll.
+    int p;
+    // Initial dealer's bankroll.
+    int d;
+    // Bet size.
+    int b;
+    // Propagation and selection rates of each island.
+    vector<double> propagate;
+    vector<double> selection_rate;
+    // Number of islands.
+    int K;
+    // Number of strategies in each island.
+    int M;
+    // Number of rounds played used to calculate fit scores.
+    int R;
+    // Number of generations between migrations.
+    int interval;
+    // Number of strategies sent at each migration.
+    int migrants;
+    // Number of strategies kept in the elite archive.
+    int archive_size;
+    // Initial strategy, random if empty.
+    vector<int> chrom;
+    // Mailbox of each island, to which the previous island sends.
+    vector<unique_ptr<Mailbox>> mailboxes;
+    // Most fit strategies found, most fit first.
+    vector<pair<vector<int>,double>> archive;
+    mutex archive_mutex;
+    // Serializes printing to console.
+    mutex print_mutex;
+    // Time series of the mean scores of each island.
+    vector<vector<double>> score_time_series;
+};
+
+Islands::Islands(int P, int D, int B, vector<double> props, vector<double> sel_rates,
+                 int m, int r, int inter, int migr, int arch){
+    p=P;
+    d=D;
+    b=B;
+    propagate=props;
+    selection_rate=sel_rates;
+    K=props.size();
+    M=m;
+    R=r;
+    interval=inter;
+    migrants=migr;
+    archive_size=arch;
+    chrom={};
+}
+
+Islands::Islands(int P, int D, int B, vector<double> props, vector<double> sel_rates,
+                 int m, int r, int inter, int migr, int arch, vector<int> c){
+    p=P;
+    d=D;
+    b=B;
+    propagate=props;
+    selection_rate=sel_rates;
+    K=props.size();
+    M=m;
+    R=r;
+    interval=inter;
+    migrants=migr;
+    archive_size=arch;
+    chrom=c;
+}
+
+void Islands::evolve(const int & generations){
+    mailboxes.clear();
+    for(int k=0;k<K;++k)
+        mailboxes.push_back(unique_ptr<Mailbox>(new Mailbox(4*migrants)));
+    score_time_series=vector<vector<double>>(K);
+    vector<thread> threads;
+    for(int k=0;k<K;++k){
+        threads.push_back(thread(&Islands::run_island,this,k,generations));
+        pin(threads[k],k);
+    }
+    for(thread & t : threads)
+        t.join();
+}
+
+void Islands::run_island(const int & k, const int & generations){
+    unique_ptr<Evolve> ev;
+    if(chrom.empty())
+        ev.reset(new Evolve(p,d,b,propagate[k],selection_rate[k],M,R));
+    else
+        ev.reset(new Evolve(p,d,b,propagate[k],selection_rate[k],M,R,chrom));
+    Mailbox & outbox=*mailboxes[(k+1)%K];
+    Mailbox & inbox=*mailboxes[k];
+    for(int g=0;g<generations;++g){
+        ev->update_fit_scores();
+        // Send the most fit to the next island.
+        if(K>1&&g>0&&g%interval==0){
+            vector<pair<vector<int>,double>> best=ev->emigrants(migrants);
+            for(const pair<vector<int>,double> & m : best)
+                outbox.send(m);
+            add_to_archive(best);
+        }
+        // Receive whatever has arrived from the previous island.
+        vector<pair<vector<int>,double>> arrived;
+        pair<vector<int>,double> m;
+        while(inbox.receive(m))
+            arrived.push_back(m);
+        if(!arrived.empty())
+            ev->immigrants(arrived);
+        double mean_fit=ev->new_generation();
+        score_time_series[k].push_back(mean_fit);
+        lock_guard<mutex> lock(print_mutex);
+        cout << "island " << k << ": fit for generation " << g << " is " << mean_fit << endl;
+    }
+    ev->update_fit_scores();
+    add_to_archive(ev->emigrants(archive_size));
+}
+
+void Islands::pin(thread & t, const int & k){
+#ifdef __linux__
+    int cores=thread::hardware_concurrency();
+    if(cores<=0)
+        return;
+    // Cores are split into K equal groups, islands share the cores
+    // if there are more islands than cores.
+    int group=max(1,cores/K);
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for(int c=k*group;c<(k+1)*group;++c)
+        CPU_SET(c%cores,&set);
+    pthread_setaffinity_np(t.native_handle(),sizeof(cpu_set_t),&set);
+#endif
+}
+
+void Islands::add_to_archive(const vector<pair<vector<int>,double>> & best){
+    lock_guard<mutex> lock(archive_mutex);
+    for(const pair<vector<int>,double> & s : best){
+        // The same strategy can be sent more than once, keep its
+        // latest fit score.
+        bool found=false;
+        for(pair<vector<int>,double> & a : archive){
+            if(a.first==s.first){
+                a.second=s.second;
+                found=true;
+                break;
+            }
+        }
+        if(!found)
+            archive.push_back(s);
+    }
+    stable_sort(archive.begin(),archive.end(),
+                [](const pair<vector<int>,double> & x, const pair<vector<int>,double> & y){
+                    return x.second>y.second;
+                });
+    if(archive.size()>archive_size)
+        archive.resize(archive_size);
+}
+
+void Islands::save(){
+    ofstream elite_stream("elite.csv");
+    for(const pair<vector<int>,double> & a : archive){
+        elite_stream << a.second;
+        for(int g : a.first)
+            elite_stream << "," << g;
+        elite_stream << endl;
+    }
+    // Fitness-weighted mean of the archive.
+    double tot_fit=0;
+    for(const pair<vector<int>,double> & a : archive)
+        tot_fit+=a.second;
+    vector<double> chromosome(800,0);
+    for(const pair<vector<int>,double> & a : archive)
+        for(int k=0;k<a.first.size();++k)
+            chromosome[k]+=(tot_fit>0 ? a.second/tot_fit : 1.0/archive.size())*a.first[k];
+    ofstream file_chromosome("chrom.csv");
+    int vsize=chromosome.size()-1;
+    for(int n=0;n<vsize;n++){
+        file_chromosome << chromosome[n];
+        file_chromosome << ",";
+    }
+    file_chromosome << chromosome[vsize];
+    // First line is the mean over islands, then each island.
+    vector<vector<double>> rows;
+    int generations=score_time_series.empty() ? 0 : score_time_series[0].size();
+    vector<double> combined(generations,0);
+    for(int g=0;g<generations;++g){
+        for(int k=0;k<K;++k)
+            combined[g]+=score_time_series[k][g];
+        combined[g]/=K;
+    }
+    rows.push_back(combined);
+    copy(score_time_series.begin(),score_time_series.end(),back_inserter(rows));
+    ofstream scores_stream("scores.csv");
+    for(const vector<double> & row : rows){
+        for(int i=0;i<row.size();++i){
+            if(i>0)
+                scores_stream << ",";
+            scores_stream << row[i];
+        }
+        scores_stream << endl;
+    }
+}
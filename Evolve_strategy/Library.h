@@ -0,0 +1,268 @@
+/**
+
+ Strategy library (.bjl), one file holding many strategies with their
+ tags, for instance all the strategies evolved by a sweep, indexed by the
+ hash of their genes. StrategyLibrary builds the library in memory and
+ saves it, LibraryView reads it in place from the file mapped into memory
+ (see MappedFile in StrategyFile.h), so that opening a library of 100k
+ strategies doesn't parse anything. See library.cpp for the tool which
+ adds, lists and plays the strategies of a library.
+
+ The file is in the native (little-endian) byte order:
+
+ * 56 byte header: uint32 magic 0x424c4a42 ("BJLB"), uint32 version 1,
+   uint32 number of strategies n, uint32 number of index buckets (a power
+   of two), uint64 offsets of the entries, the index and the tags, uint64
+   size of the tags, uint64 reserved,
+ * n entries of 128 bytes: uint64 hash, 100 bytes of genes packed as in
+   StrategyFile.h, 4 bytes padding, uint32 rules (as in StrategyFile.h),
+   uint32 offset and uint32 length of the tags, uint32 reserved,
+ * the index, uint32 per bucket: one plus the number of the entry, or 0
+   for an empty bucket. The entry with hash h is in the bucket h modulo
+   the number of buckets or in one of the following ones (linear probing),
+ * the tags of all entries, each entry's tags being a string of tags
+   separated by ','.
+
+ The hash is the 64-bit FNV-1a hash of the packed genes. The same
+ strategy under the same rules is stored only once, with the tags of all
+ of its additions; under other rules it is another entry, with the same
+ hash, so find() takes the rules as well as the genes.
+
+ */
+
+using namespace std;
+
+const unsigned LIBRARY_MAGIC=0x424c4a42;
+const unsigned LIBRARY_VERSION=1;
+
+struct LibraryHeader{
+    unsigned magic;
+    unsigned version;
+    unsigned n;
+    unsigned buckets;
+    unsigned long long entries_offset;
+    unsigned long long index_offset;
+    unsigned long long tags_offset;
+    unsigned long long tags_size;
+    unsigned long long reserved;
+};
+
+struct LibraryEntry{
+    unsigned long long hash;
+    unsigned char packed[100];
+    unsigned char padding[4];
+    unsigned rules;
+    unsigned tags_offset;
+    unsigned tags_length;
+    unsigned reserved;
+};
+
+// 64-bit FNV-1a hash of the packed genes.
+unsigned long long library_hash(const unsigned char * packed){
+    unsigned long long hash=14695981039346656037ULL;
+    for(int k=0;k<100;++k){
+        hash^=packed[k];
+        hash*=1099511628211ULL;
+    }
+    return hash;
+}
+
+// Split the string of tags separated by ','.
+vector<string> split_tags(const string & tags){
+    vector<string> ret;
+    stringstream tags_stream(tags);
+    string tag;
+    while(getline(tags_stream,tag,','))
+        if(!tag.empty())
+            ret.push_back(tag);
+    return ret;
+}
+
+class LibraryView{
+public:
+    // Constructor takes the library file.
+    LibraryView(const string &);
+    // False if the file is not a valid library.
+    bool valid(){
+        return header!=nullptr;
+    }
+    int size(){
+        return header ? header->n : 0;
+    }
+    unsigned long long hash(const int & i){
+        return entries[i].hash;
+    }
+    const unsigned char * packed(const int & i){
+        return entries[i].packed;
+    }
+    unsigned rules(const int & i){
+        return entries[i].rules;
+    }
+    vector<int> chromosome(const int & i);
+    string tags(const int & i);
+    // Number of the entry with the given packed genes and rules, -1 if
+    // none.
+    int find(const unsigned char *, const unsigned & rules=0);
+    // Numbers of the entries with the given tag.
+    vector<int> with_tag(const string &);
+private:
+    MappedFile file;
+    const LibraryHeader * header;
+    const LibraryEntry * entries;
+    const unsigned * index;
+    const char * tag_strings;
+};
+
+LibraryView::LibraryView(const string & f) : file(f){
+    header=nullptr;
+    const LibraryHeader * h=(const LibraryHeader *) file.data();
+    if(file.size()<sizeof(LibraryHeader)||h->magic!=LIBRARY_MAGIC
+       ||h->version!=LIBRARY_VERSION||h->buckets==0
+       ||h->entries_offset+128ULL*h->n>file.size()
+       ||h->index_offset+4ULL*h->buckets>file.size()
+       ||h->tags_offset+h->tags_size>file.size())
+        return;
+    header=h;
+    entries=(const LibraryEntry *) (file.data()+h->entries_offset);
+    index=(const unsigned *) (file.data()+h->index_offset);
+    tag_strings=file.data()+h->tags_offset;
+}
+
+vector<int> LibraryView::chromosome(const int & i){
+    vector<int> chrom(800);
+    for(int k=0;k<800;++k)
+        chrom[k]=(entries[i].packed[k/8]>>(k%8))&1;
+    return chrom;
+}
+
+string LibraryView::tags(const int & i){
+    return string(tag_strings+entries[i].tags_offset,entries[i].tags_length);
+}
+
+int LibraryView::find(const unsigned char * packed, const unsigned & rules){
+    if(!header)
+        return -1;
+    unsigned long long h=library_hash(packed);
+    for(unsigned b=h%header->buckets;index[b]!=0;b=(b+1)%header->buckets){
+        int i=index[b]-1;
+        if(entries[i].hash==h&&entries[i].rules==rules&&memcmp(entries[i].packed,packed,100)==0)
+            return i;
+    }
+    return -1;
+}
+
+vector<int> LibraryView::with_tag(const string & tag){
+    vector<int> ret;
+    for(int i=0;i<size();++i){
+        vector<string> t=split_tags(tags(i));
+        if(std::find(t.begin(),t.end(),tag)!=t.end())
+            ret.push_back(i);
+    }
+    return ret;
+}
+
+class StrategyLibrary{
+public:
+    // Empty library.
+    StrategyLibrary(){}
+    // Library with the strategies of the given library file, if any.
+    StrategyLibrary(const string &);
+    // Add the strategy with the given tags (separated by ','), or add the
+    // tags to it if it is already there. Returns its number.
+    int add(const vector<int> &, const string &, const unsigned & rules=0);
+    // Save the library to the file.
+    bool save(const string &);
+    int size(){
+        return entries.size();
+    }
+private:
+    struct Entry{
+        unsigned long long hash;
+        vector<unsigned char> packed;
+        unsigned rules;
+        vector<string> tags;
+    };
+    vector<Entry> entries;
+    // Numbers of the entries with the given hash.
+    multimap<unsigned long long,int> by_hash;
+};
+
+StrategyLibrary::StrategyLibrary(const string & file){
+    LibraryView view(file);
+    for(int i=0;i<view.size();++i)
+        add(view.chromosome(i),view.tags(i),view.rules(i));
+}
+
+int StrategyLibrary::add(const vector<int> & chrom, const string & tags,
+                         const unsigned & rules){
+    Entry entry;
+    entry.packed=vector<unsigned char>(100,0);
+    for(int k=0;k<chrom.size()&&k<800;++k)
+        if(chrom[k]==1)
+            entry.packed[k/8]|=(1<<(k%8));
+    entry.hash=library_hash(entry.packed.data());
+    entry.rules=rules;
+    int i=-1;
+    auto range=by_hash.equal_range(entry.hash);
+    for(auto it=range.first;it!=range.second;++it)
+        if(entries[it->second].packed==entry.packed&&entries[it->second].rules==rules)
+            i=it->second;
+    if(i<0){
+        i=entries.size();
+        entries.push_back(entry);
+        by_hash.insert(make_pair(entry.hash,i));
+    }
+    for(const string & tag : split_tags(tags))
+        if(std::find(entries[i].tags.begin(),entries[i].tags.end(),tag)==entries[i].tags.end())
+            entries[i].tags.push_back(tag);
+    return i;
+}
+
+bool StrategyLibrary::save(const string & file){
+    LibraryHeader h;
+    memset(&h,0,sizeof(h));
+    h.magic=LIBRARY_MAGIC;
+    h.version=LIBRARY_VERSION;
+    h.n=entries.size();
+    // At most half of the buckets are used.
+    h.buckets=1;
+    while(h.buckets<2*h.n)
+        h.buckets*=2;
+    vector<LibraryEntry> table(h.n);
+    vector<unsigned> index(h.buckets,0);
+    string tag_strings;
+    for(int i=0;i<h.n;++i){
+        LibraryEntry & e=table[i];
+        memset(&e,0,sizeof(e));
+        e.hash=entries[i].hash;
+        memcpy(e.packed,entries[i].packed.data(),100);
+        e.rules=entries[i].rules;
+        string tags;
+        for(int t=0;t<entries[i].tags.size();++t)
+            tags+=(t>0 ? "," : "")+entries[i].tags[t];
+        e.tags_offset=tag_strings.size();
+        e.tags_length=tags.size();
+        tag_strings+=tags;
+        unsigned b=e.hash%h.buckets;
+        while(index[b]!=0)
+            b=(b+1)%h.buckets;
+        index[b]=i+1;
+    }
+    h.entries_offset=sizeof(h);
+    h.index_offset=h.entries_offset+sizeof(LibraryEntry)*h.n;
+    h.tags_offset=h.index_offset+4ULL*h.buckets;
+    h.tags_size=tag_strings.size();
+    // Written next to the file first, so that a library is never left
+    // half written.
+    string tmp=file+".tmp";
+    {
+        ofstream os(tmp,ios::binary);
+        os.write((const char *) &h,sizeof(h));
+        os.write((const char *) table.data(),sizeof(LibraryEntry)*h.n);
+        os.write((const char *) index.data(),4*h.buckets);
+        os.write(tag_strings.data(),tag_strings.size());
+        if(!os)
+            return false;
+    }
+    return rename(tmp.c_str(),file.c_str())==0;
+}
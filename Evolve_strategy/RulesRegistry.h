@@ -0,0 +1,131 @@
+/**
+
+ Registry of the house rules the tools can play at run time. Each entry
+ is one of the rules of Rules.h with its number, its name, and the
+ function which plays a strategy round by round under these rules, made
+ from the GameEngine of the chromosome and these rules (see Engine.h)
+ when the tool is compiled. The number is the one stored as the rules of
+ a strategy in the .bjs files (StrategyFile.h) and in the libraries
+ (Library.h), and the one asked for in the requests of
+ evaluation_server.cpp; 0 is the rules of Game.h. The numbers of the
+ existing entries must never change, new rules go at the end.
+
+ */
+
+using namespace std;
+
+// Result of a strategy played round by round.
+struct RoundsPlayed{
+    // Number of rounds played, less than asked for if the player or the
+    // dealer went bankrupt.
+    int rounds;
+    // Final and lowest player's bankroll.
+    int bankroll;
+    int lowest;
+    // Sum of the results of the rounds, and of their squares, in units of
+    // bet.
+    double sum;
+    double sum2;
+};
+
+// Plays the strategy given by its genes round by round under the rules,
+// for the given bankrolls of the player and the dealer, bet size and
+// number of rounds, on the deck seeded by the given seed if 'seeded', or
+// on the given shoes of a shoe bank (see ShoeBank::shoes()), their
+// number and the cards per shoe, if they are not nullptr.
+template<class Rules>
+RoundsPlayed play_rounds(const vector<int> & chrom, int p, int d, int b, int rounds,
+                         bool seeded, unsigned seed, const unsigned char * shoes,
+                         int cards, unsigned long long count){
+    GameEngine<Chromosome,Rules> game(p,d,b,chrom);
+    if(shoes!=nullptr)
+        game.use_bank(shoes,cards,count);
+    else if(seeded)
+        game.seed(seed);
+    RoundsPlayed played={0,game.get_player_bankroll(),game.get_player_bankroll(),0,0};
+    for(int r=1;r<=rounds;++r){
+        game.play(r);
+        if(game.get_rounds_played()<r)
+            break;
+        double x=double(game.get_player_bankroll()-played.bankroll)/b;
+        played.bankroll=game.get_player_bankroll();
+        played.lowest=min(played.lowest,played.bankroll);
+        played.sum+=x;
+        played.sum2+=x*x;
+    }
+    played.rounds=game.get_rounds_played();
+    return played;
+}
+
+struct RulesVariant{
+    unsigned number;
+    string name;
+    // The rules in words, made from the constants of the rules.
+    string description;
+    // Most bets a round can cost, two for each hand of a split pair.
+    int max_bets;
+    // The bet size must be a multiple of it for the payouts to be whole
+    // numbers of chips (the natural, and half the bet of the surrender),
+    // 5 for the natural paying 6 to 5.
+    int bet_multiple;
+    // Number of decks, the shoes of a shoe bank must have at least as many.
+    int decks;
+    RoundsPlayed (*play)(const vector<int> &, int, int, int, int, bool, unsigned,
+                         const unsigned char *, int, unsigned long long);
+};
+
+// Entry of the registry for the given rules.
+template<class Rules>
+RulesVariant rules_variant(const unsigned & number, const string & name){
+    stringstream description;
+    description << Rules::decks << (Rules::decks==1 ? " deck" : " decks")
+                << (Rules::dealer_hits_soft_17 ? ", H17" : ", S17")
+                << (Rules::double_after_split ? ", DAS" : ", no DAS");
+    if(Rules::split_hands>2)
+        description << ", resplit to " << Rules::split_hands << " hands";
+    else
+        description << ", no resplit";
+    description << ", split aces " << Rules::split_aces_cards << " cards"
+                << (Rules::surrender ? ", late surrender" : "")
+                << ", natural pays " << Rules::natural_pays;
+    int multiple=1;
+    while(multiple<100&&(abs(Rules::natural_pays*multiple-round(Rules::natural_pays*multiple))>1e-9
+                         ||(Rules::surrender&&multiple%2!=0)))
+        ++multiple;
+    RulesVariant variant={number,name,description.str(),max_bets<Rules>(),multiple,
+                          Rules::decks,&play_rounds<Rules>};
+    return variant;
+}
+
+// All rules, in the order of their numbers.
+const vector<RulesVariant> & rules_registry(){
+    static const vector<RulesVariant> registry={
+        rules_variant<RulesS17>(0,"s17"),
+        rules_variant<RulesH17>(1,"h17"),
+        rules_variant<RulesNoDAS>(2,"nodas"),
+        rules_variant<RulesSixToFive>(3,"6to5"),
+        rules_variant<RulesSurrender>(4,"surrender"),
+        rules_variant<RulesShoeS17>(5,"shoe_s17"),
+        rules_variant<RulesShoeH17>(6,"shoe_h17")
+    };
+    return registry;
+}
+
+// The rules with the given number, nullptr if there are none, or if a bet
+// size is given which is not a multiple of their bet_multiple.
+const RulesVariant * find_rules(const unsigned & number, const int & bet=0){
+    const vector<RulesVariant> & registry=rules_registry();
+    if(number>=registry.size())
+        return nullptr;
+    const RulesVariant & variant=registry[number];
+    return (bet==0||bet%variant.bet_multiple==0) ? &variant : nullptr;
+}
+
+// The rules with the given name or number, nullptr if there are none, or
+// if a bet size is given which is not a multiple of their bet_multiple.
+const RulesVariant * find_rules(const string & name, const int & bet=0){
+    for(const RulesVariant & variant : rules_registry())
+        if(variant.name==name||to_string(variant.number)==name)
+            return (bet==0||bet%variant.bet_multiple==0) ? &variant : nullptr;
+    return nullptr;
+}
@@ -0,0 +1,188 @@
+/**
+
+ SegmentEvaluator is the Evaluator which splits the R rounds played by
+ each strategy into S segments and plays the segments on the ThreadPool
+ at the same time. This helps when the population is small and R is
+ large, so that there are too few strategies to keep all threads busy.
+
+ Splitting is possible because the Game reshuffles the deck once a third
+ of it is dealt, so the rounds after a reshuffle don't depend on the
+ rounds before it. Each segment starts from a freshly shuffled deck, of
+ its own seed made out of the seed of the strategy and the segment
+ index, so the result doesn't depend on which thread plays which segment.
+
+ If it is given a common seed, all strategies of generation 'g' play the
+ segments of the same seed, made out of the common seed and 'g' in the
+ same way as in PoolEvaluator (see ThreadPool.h), so they play the same
+ cards (common random numbers), and a resumed run plays them exactly as
+ the original one. If it is given a shoe bank (see ShoeBank.h), segment
+ 'k' plays the shoes of the bank picked by its seed instead of shuffling.
+
+ The segments are played without the bankruptcy cutoff of Game::play(),
+ recording the net result of the segment and the lowest and highest
+ running net result within it. The cutoff is then rebuilt by scanning the
+ segments in order: the bankrolls at the start of segment 'k' are the
+ initial ones plus the net results of the segments before it, and if
+ the lowest (highest) running net result of segment 'k' would take the
+ player's (dealer's) bankroll to zero, segment 'k' is replayed from the
+ same seed with the actual bankrolls, where it stops exactly where the
+ Game would have stopped. The fit score is the same function of the
+ final bankroll as in fit_score() (see Evaluator.h).
+
+ */
+
+using namespace std;
+
+struct Segment{
+    // Net result of the player over the segment.
+    int net;
+    // Lowest and highest running net result within the segment.
+    int lowest;
+    int highest;
+    // Number of rounds of the segment.
+    int rounds;
+};
+
+// Seed of segment 'k' of the strategy with the given seed.
+unsigned segment_seed(const unsigned & seed, const int & k){
+    unsigned s;
+    seed_seq seq{seed,(unsigned) k};
+    seq.generate(&s,&s+1);
+    return s;
+}
+
+// Start the segment of the given number of rounds and seed on the Game:
+// seed its deck, or, if a bank is given, hand it the shoes of the bank
+// picked by the seed, as many as it can use in these rounds.
+void start_segment(Game & game, const int & rounds, const unsigned & seed, ShoeBank * bank){
+    if(bank==nullptr){
+        game.seed(seed);
+        return;
+    }
+    unsigned long long count=rounds+1;
+    const unsigned char * shoes=bank->shoes(seed,count);
+    game.use_bank(shoes,bank->cards(),count);
+}
+
+// Plays the given number of rounds on the copy of the Game, from the deck
+// with the given seed (or the shoes of the bank it picks), with bankrolls
+// large enough to never go bankrupt.
+Segment play_segment(Game game, const int & rounds, const unsigned & seed, ShoeBank * bank){
+    // A round can't cost more than the most bets of the rules of the Game.
+    int start=Game::get_max_bets()*game.get_bet_size()*rounds+1;
+    game.set_player_bankroll(start);
+    game.set_dealer_bankroll(start);
+    start_segment(game,rounds,seed,bank);
+    Segment segment={0,0,0,rounds};
+    for(int r=1;r<=rounds;++r){
+        game.play(r);
+        int net=game.get_player_bankroll()-start;
+        segment.lowest=min(segment.lowest,net);
+        segment.highest=max(segment.highest,net);
+    }
+    segment.net=game.get_player_bankroll()-start;
+    return segment;
+}
+
+// Fit score of the Game from its segments, for the given initial player's
+// bankroll; the dealer's bankroll is the one of the Game.
+double segmented_fit_score(const Game & game, const vector<Segment> & segments,
+                           const unsigned & seed, ShoeBank * bank, const int & p){
+    int player=p;
+    int dealer=Game(game).get_dealer_bankroll();
+    for(int k=0;k<segments.size();++k){
+        const Segment & s=segments[k];
+        if(player+s.lowest<=0||dealer-s.highest<=0){
+            Game replay=game;
+            replay.set_player_bankroll(player);
+            replay.set_dealer_bankroll(dealer);
+            start_segment(replay,s.rounds,segment_seed(seed,k),bank);
+            replay.play(s.rounds);
+            player=replay.get_player_bankroll();
+            dealer=replay.get_dealer_bankroll();
+            if(replay.get_rounds_played()<s.rounds)
+                break;
+            continue;
+        }
+        player+=s.net;
+        dealer-=s.net;
+    }
+    if(player<=0)
+        return 0;
+    return double(player)/p;
+}
+
+class SegmentEvaluator : public Evaluator{
+public:
+    // Constructor takes the pool, the number of segments and the common
+    // seed, zero meaning that each strategy plays segments of its own
+    // random seed.
+    SegmentEvaluator(ThreadPool &, int, unsigned);
+    // Fit scores of the population, its segments played on the pool.
+    vector<double> evaluate(vector<Game> &, const int &, const int &);
+    // Continue the seeds after the given number of evaluations, used when
+    // the run is resumed from a checkpoint.
+    void set_generation(const int & g){
+        generation=g;
+    }
+    // Play the shoes of the given bank, nullptr to shuffle again. The bank
+    // must outlive the evaluator.
+    void set_shoe_bank(ShoeBank * b){
+        bank=b;
+    }
+private:
+    ThreadPool & pool;
+    int client;
+    // Number of segments of each strategy.
+    int S;
+    unsigned common_seed;
+    // Number of generations evaluated so far.
+    int generation;
+    // Shoe bank the segments play, if any.
+    ShoeBank * bank;
+};
+
+SegmentEvaluator::SegmentEvaluator(ThreadPool & tp, int s, unsigned seed) : pool(tp){
+    client=pool.add_client();
+    S=max(1,s);
+    common_seed=seed;
+    generation=0;
+    bank=nullptr;
+}
+
+vector<double> SegmentEvaluator::evaluate(vector<Game> & population, const int & R, const int & p){
+    unsigned generation_seed=0;
+    if(common_seed!=0){
+        seed_seq seq{common_seed,(unsigned) generation};
+        seq.generate(&generation_seed,&generation_seed+1);
+    }
+    generation++;
+    int M=population.size();
+    vector<unsigned> seeds;
+    for(int i=0;i<M;++i)
+        seeds.push_back(common_seed!=0 ? generation_seed : rand());
+    ShoeBank * shoe_bank=bank;
+    // Segment 'k' gets R/S rounds, the first R%S segments one more.
+    vector<vector<Segment>> segments(M,vector<Segment>(S));
+    vector<function<void()>> tasks;
+    for(int i=0;i<M;++i){
+        for(int k=0;k<S;++k){
+            int rounds=R/S+(k<R%S ? 1 : 0);
+            tasks.push_back([&population,&segments,&seeds,shoe_bank,i,k,rounds]{
+                segments[i][k]=play_segment(population[i],rounds,segment_seed(seeds[i],k),shoe_bank);
+            });
+        }
+    }
+    pool.run(client,tasks);
+    // Rebuild the cutoff; replays are rare but can be long, so they are
+    // played on the pool too.
+    vector<double> scores(M);
+    tasks.clear();
+    for(int i=0;i<M;++i){
+        tasks.push_back([&population,&segments,&seeds,&scores,shoe_bank,i,p]{
+            scores[i]=segmented_fit_score(population[i],segments[i],seeds[i],shoe_bank,p);
+        });
+    }
+    pool.run(client,tasks);
+    return scores;
+}
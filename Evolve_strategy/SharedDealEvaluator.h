@@ -0,0 +1,119 @@
+/**
+
+ SharedDealEvaluator is the Evaluator which plays the population on the
+ shared deal (see SharedDeal.h): the population is cut into groups of K
+ strategies, and each group is played on the ThreadPool as one task,
+ which deals each round once and plays it for all strategies of the
+ group. All groups of a generation play the same rounds, dealt from the
+ seed made out of the common seed and the generation (or out of a random
+ seed if the common seed is zero), or from the shoes of the shoe bank
+ picked by that seed if a bank is given.
+
+ If it is given a DealerSampler, the dealer's outcome of each round is
+ sampled instead of played out, and with the infinite deck sampler the
+ rounds are dealt from the infinite deck.
+
+ The shuffle and the dealer's play of a round are done once per group
+ instead of once per strategy, so K is best as large as possible while
+ there are still enough groups to keep the threads of the pool busy; if
+ K is zero the population is cut into as many groups as the pool has
+ threads.
+
+ */
+
+using namespace std;
+
+class SharedDealEvaluator : public Evaluator{
+public:
+    // Constructor takes the pool, the common seed (zero meaning a new
+    // random seed for each generation) and the number of strategies K
+    // which share the deal.
+    SharedDealEvaluator(ThreadPool &, unsigned, int);
+    // Fit scores of the population, played on the pool.
+    vector<double> evaluate(vector<Game> &, const int &, const int &);
+    // Play the shoes of the given bank, nullptr to shuffle again. The bank
+    // must outlive the evaluator.
+    void set_shoe_bank(ShoeBank * b){
+        bank=b;
+    }
+    // Sample the dealer's outcome from the given sampler instead of
+    // drawing the dealer's cards (see SharedDeal.h), nullptr to draw them.
+    // The sampler must outlive the evaluator.
+    void set_dealer_sampler(const DealerSampler * s){
+        sampler=s;
+    }
+    // Continue the seeds after the given number of evaluations, used when
+    // the run is resumed from a checkpoint.
+    void set_generation(const int & g){
+        generation=g;
+    }
+private:
+    ThreadPool & pool;
+    int client;
+    unsigned common_seed;
+    int K;
+    int generation;
+    ShoeBank * bank;
+    const DealerSampler * sampler;
+};
+
+SharedDealEvaluator::SharedDealEvaluator(ThreadPool & tp, unsigned seed, int k) : pool(tp){
+    client=pool.add_client();
+    common_seed=seed;
+    K=k;
+    generation=0;
+    bank=nullptr;
+    sampler=nullptr;
+}
+
+vector<double> SharedDealEvaluator::evaluate(vector<Game> & population, const int & R, const int & p){
+    unsigned deal_seed=rand();
+    if(common_seed!=0){
+        seed_seq seq{common_seed,(unsigned) generation};
+        seq.generate(&deal_seed,&deal_seed+1);
+    }
+    generation++;
+    const unsigned char * shoes=nullptr;
+    unsigned long long count=R;
+    if(bank!=nullptr)
+        shoes=bank->shoes(deal_seed,count);
+    int cards=(bank!=nullptr) ? bank->cards() : 0;
+    int M=population.size();
+    int group=K>0 ? K : (M+pool.get_workers()-1)/pool.get_workers();
+    group=max(1,group);
+    vector<double> scores(M);
+    vector<function<void()>> tasks;
+    for(int first=0;first<M;first+=group){
+        int last=min(M,first+group);
+        const DealerSampler * dealer_sampler=sampler;
+        tasks.push_back([&population,&scores,first,last,deal_seed,shoes,cards,count,
+                         dealer_sampler,R,p]{
+            vector<SharedPlayer> players;
+            for(int i=first;i<last;++i){
+                Game & game=population[i];
+                players.push_back(SharedPlayer(game.flatten(),game.get_player_bankroll(),
+                                               game.get_dealer_bankroll(),game.get_bet_size()));
+            }
+            SharedDeal deal=(shoes!=nullptr) ? SharedDeal(shoes,cards,count,deal_seed) :
+                SharedDeal(deal_seed);
+            deal.set_dealer_sampler(dealer_sampler);
+            for(int round=0;round<R;++round){
+                bool active=false;
+                for(SharedPlayer & player : players)
+                    active=active||player.active();
+                if(!active)
+                    break;
+                deal.next();
+                for(SharedPlayer & player : players)
+                    player.play_round(deal);
+            }
+            for(int i=first;i<last;++i){
+                SharedPlayer & player=players[i-first];
+                scores[i]=(player.get_player_bankroll()<=0) ? 0 :
+                    (double) player.get_player_bankroll()/p;
+            }
+        });
+    }
+    pool.run(client,tasks);
+    return scores;
+}
@@ -0,0 +1,316 @@
+/**
+
+ StagedEvaluator is the Evaluator which plays the population in two
+ stages, so that the strategies which can't make the selection cut of
+ Evolve don't take the full rounds to find that out.
+
+ * Stage one plays every strategy for a few rounds (R1) on the shared
+   deal with the infinite deck (see SharedDeal.h), where nothing is
+   shuffled and the dealer's outcome is sampled with one random number
+   per round, all strategies on the same rounds, on the ThreadPool. The
+   score of stage one is the mean net result per round in bets.
+ * Stage two plays the finalists for the full R rounds with the Evaluator
+   it is given (the pool, the segments, the shared deal, the control
+   variate or the worker processes), whose fit scores they keep.
+
+ Which strategies are finalists is calibrated from the strategies of the
+ last few generations which were played in both stages: the fit score of
+ stage two is regressed on the score of stage one, and the strategies
+ whose predicted fit score is within z residual standard deviations of
+ the predicted score of the last one to make the selection cut are the
+ finalists. The better the stages agree, the fewer the finalists. Until
+ there is anything to calibrate from, that is in the first generation,
+ all strategies are finalists.
+
+ So that the calibration sees the whole range of stage one, and not only
+ its top, a small random share of the other strategies (the audit) is
+ played in stage two as well. The audited strategies which made the
+ selection cut in stage two are the ones stage one would have missed.
+ The strategies played only in stage one get their predicted fit score,
+ kept below that of every strategy played in stage two, so that only
+ strategies played in full are selected.
+
+ The window of the calibration is not saved in the checkpoint (see
+ Checkpoint.h), so a resumed run starts without it and plays all
+ strategies of its first generation in full; the seeds continue as in
+ the original run (see set_generation()), but the fit scores and the
+ finalists differ from it, and the staged run does not resume exactly.
+
+ For each generation it keeps the number of finalists and audited
+ strategies, the misses of the audit, the rank correlation of the two
+ stages, and the CPU and wall times of each stage, see report().
+
+ */
+
+using namespace std;
+
+// What happened in one generation of the StagedEvaluator.
+struct StageTelemetry{
+    int finalists;
+    int audited;
+    // Audited strategies which made the selection cut in stage two.
+    int missed;
+    // Spearman correlation of the stages over the strategies played in both.
+    double rank_correlation;
+    // CPU time of the process and wall time of each stage, in seconds.
+    double cpu_one;
+    double cpu_two;
+    double wall_one;
+    double wall_two;
+};
+
+// Spearman correlation of the two vectors, the correlation of their ranks.
+double rank_correlation(const vector<double> & a, const vector<double> & b){
+    int n=a.size();
+    if(n<2)
+        return 0;
+    vector<vector<double>> ranks(2,vector<double>(n));
+    for(int v=0;v<2;++v){
+        const vector<double> & x=(v==0) ? a : b;
+        vector<int> order(n);
+        for(int i=0;i<n;++i)
+            order[i]=i;
+        sort(order.begin(),order.end(),[&x](int i, int j){return x[i]<x[j];});
+        // Tied values get their mean rank.
+        for(int i=0;i<n;){
+            int j=i;
+            while(j+1<n&&x[order[j+1]]==x[order[i]])
+                ++j;
+            for(int k=i;k<=j;++k)
+                ranks[v][order[k]]=(i+j)/2.0;
+            i=j+1;
+        }
+    }
+    double mean=(n-1)/2.0;
+    double cov=0;
+    double var_a=0;
+    double var_b=0;
+    for(int i=0;i<n;++i){
+        cov+=(ranks[0][i]-mean)*(ranks[1][i]-mean);
+        var_a+=(ranks[0][i]-mean)*(ranks[0][i]-mean);
+        var_b+=(ranks[1][i]-mean)*(ranks[1][i]-mean);
+    }
+    return (var_a>0&&var_b>0) ? cov/sqrt(var_a*var_b) : 0;
+}
+
+class StagedEvaluator : public Evaluator{
+public:
+    // Constructor takes the pool playing stage one, the Evaluator playing
+    // stage two, the common seed (zero meaning a new random seed for each
+    // generation), the selection rate of Evolve, the rounds R1 of stage
+    // one, the number z of residual standard deviations, the share of the
+    // other strategies audited, and the number of generations the
+    // calibration is made from.
+    StagedEvaluator(ThreadPool &, Evaluator *, unsigned, const double &, const int &,
+                    const double & =1, const double & =0.05, const int & =5);
+    // Fit scores of the population.
+    vector<double> evaluate(vector<Game> &, const int &, const int &);
+    // Print the CPU time of each stage and how well the stages agreed.
+    void report(ostream &);
+    // Continue the seeds after the given number of evaluations, used when
+    // the run is resumed from a checkpoint. The calibration starts over.
+    void set_generation(const int & g){
+        generation=g;
+    }
+    // Interfaces to private variables.
+    Evaluator * get_full_evaluator(){
+        return full;
+    }
+    vector<StageTelemetry> get_telemetry(){
+        return telemetry;
+    }
+private:
+    // Stage one scores of the population, played on the pool.
+    vector<double> screen(vector<Game> &, const unsigned &);
+    ThreadPool & pool;
+    int client;
+    Evaluator * full;
+    unsigned common_seed;
+    double selection_rate;
+    int R1;
+    double z;
+    double audit;
+    int window;
+    int generation;
+    DealerSampler infinite_deck;
+    // Scores of both stages of the strategies played in both, for each of
+    // the last 'window' generations.
+    deque<vector<pair<double,double>>> pairs;
+    vector<StageTelemetry> telemetry;
+};
+
+StagedEvaluator::StagedEvaluator(ThreadPool & tp, Evaluator * e, unsigned seed, const double & sel_rate,
+                                 const int & r1, const double & zz, const double & a,
+                                 const int & w) : pool(tp), infinite_deck(0){
+    client=pool.add_client();
+    full=e;
+    common_seed=seed;
+    selection_rate=sel_rate;
+    R1=max(1,r1);
+    z=zz;
+    audit=a;
+    window=max(1,w);
+    generation=0;
+}
+
+// Large enough bankrolls that nobody goes bankrupt in stage one.
+const int STAGE_ONE_BANKROLL=1<<30;
+
+vector<double> StagedEvaluator::screen(vector<Game> & population, const unsigned & deal_seed){
+    int M=population.size();
+    int group=max(1,(M+pool.get_workers()-1)/pool.get_workers());
+    vector<double> scores(M);
+    vector<function<void()>> tasks;
+    for(int first=0;first<M;first+=group){
+        int last=min(M,first+group);
+        const DealerSampler * sampler=&infinite_deck;
+        int R=R1;
+        tasks.push_back([&population,&scores,first,last,deal_seed,sampler,R]{
+            vector<SharedPlayer> players;
+            for(int i=first;i<last;++i)
+                players.push_back(SharedPlayer(population[i].flatten(),STAGE_ONE_BANKROLL,
+                                               STAGE_ONE_BANKROLL,population[i].get_bet_size()));
+            SharedDeal deal(deal_seed);
+            deal.set_dealer_sampler(sampler);
+            for(int round=0;round<R;++round){
+                deal.next();
+                for(SharedPlayer & player : players)
+                    player.play_round(deal);
+            }
+            for(int i=first;i<last;++i){
+                double net=players[i-first].get_player_bankroll()-STAGE_ONE_BANKROLL;
+                scores[i]=net/population[i].get_bet_size()/R;
+            }
+        });
+    }
+    pool.run(client,tasks);
+    return scores;
+}
+
+vector<double> StagedEvaluator::evaluate(vector<Game> & population, const int & R, const int & p){
+    unsigned deal_seed=rand();
+    if(common_seed!=0){
+        seed_seq seq{common_seed,(unsigned) generation,2u};
+        seq.generate(&deal_seed,&deal_seed+1);
+    }
+    generation++;
+    mt19937 audit_engine(deal_seed);
+    int M=population.size();
+    int select=max(1,int(selection_rate*M));
+    StageTelemetry t;
+    clock_t cpu=clock();
+    chrono::steady_clock::time_point start=chrono::steady_clock::now();
+    vector<double> first=screen(population,deal_seed);
+    t.cpu_one=double(clock()-cpu)/CLOCKS_PER_SEC;
+    t.wall_one=chrono::duration<double>(chrono::steady_clock::now()-start).count();
+    // Regression of the fit score of stage two on the score of stage one.
+    long long n=0;
+    double sx=0;
+    double sy=0;
+    double sxx=0;
+    double sxy=0;
+    double syy=0;
+    for(const vector<pair<double,double>> & g : pairs)
+        for(const pair<double,double> & xy : g){
+            ++n;
+            sx+=xy.first;
+            sy+=xy.second;
+            sxx+=xy.first*xy.first;
+            sxy+=xy.first*xy.second;
+            syy+=xy.second*xy.second;
+        }
+    double var_x=sxx-sx*sx/max(1LL,n);
+    double slope=(n>2&&var_x>0) ? (sxy-sx*sy/n)/var_x : 0;
+    double intercept=(n>0) ? (sy-slope*sx)/n : 0;
+    double residual=(n>2) ? sqrt(max(0.0,(syy-sy*sy/n-slope*(sxy-sx*sy/n))/(n-2))) : 0;
+    vector<double> predicted(M);
+    for(int i=0;i<M;++i)
+        predicted[i]=intercept+slope*first[i];
+    // The finalists, and the audited strategies among the others.
+    vector<char> finalist(M,1);
+    vector<char> audited(M,0);
+    if(n>2&&slope>0){
+        vector<double> sorted=predicted;
+        sort(sorted.begin(),sorted.end(),greater<double>());
+        double cut=sorted[min(select,M)-1]-z*residual;
+        uniform_real_distribution<double> u(0,1);
+        for(int i=0;i<M;++i){
+            finalist[i]=predicted[i]>=cut;
+            audited[i]=!finalist[i]&&u(audit_engine)<audit;
+        }
+    }
+    vector<Game> played;
+    vector<int> index;
+    t.finalists=0;
+    t.audited=0;
+    for(int i=0;i<M;++i)
+        if(finalist[i]||audited[i]){
+            played.push_back(population[i]);
+            index.push_back(i);
+            t.finalists+=finalist[i];
+            t.audited+=audited[i];
+        }
+    cpu=clock();
+    start=chrono::steady_clock::now();
+    vector<double> second=full->evaluate(played,R,p);
+    t.cpu_two=double(clock()-cpu)/CLOCKS_PER_SEC;
+    t.wall_two=chrono::duration<double>(chrono::steady_clock::now()-start).count();
+    vector<double> scores(M);
+    vector<double> played_first;
+    vector<pair<double,double>> g;
+    double lowest=second[0];
+    for(int k=0;k<index.size();++k){
+        scores[index[k]]=second[k];
+        played_first.push_back(first[index[k]]);
+        g.push_back(make_pair(first[index[k]],second[k]));
+        lowest=min(lowest,second[k]);
+    }
+    // The strategies played only in stage one rank below all others.
+    double below=nextafter(lowest,0.0);
+    for(int i=0;i<M;++i)
+        if(!finalist[i]&&!audited[i])
+            scores[i]=max(0.0,min(predicted[i],below));
+    // The selection cut of stage two, and the audited strategies above it.
+    vector<double> sorted=second;
+    sort(sorted.begin(),sorted.end(),greater<double>());
+    double made=sorted[min(select,int(sorted.size()))-1];
+    t.missed=0;
+    for(int k=0;k<index.size();++k)
+        if(audited[index[k]]&&second[k]>=made)
+            ++t.missed;
+    t.rank_correlation=rank_correlation(played_first,second);
+    telemetry.push_back(t);
+    pairs.push_back(g);
+    while(pairs.size()>window)
+        pairs.pop_front();
+    return scores;
+}
+
+void StagedEvaluator::report(ostream & os){
+    if(telemetry.empty())
+        return;
+    double cpu_one=0;
+    double cpu_two=0;
+    double wall_one=0;
+    double wall_two=0;
+    long long finalists=0;
+    long long audited=0;
+    long long missed=0;
+    double correlation=0;
+    for(const StageTelemetry & t : telemetry){
+        cpu_one+=t.cpu_one;
+        cpu_two+=t.cpu_two;
+        wall_one+=t.wall_one;
+        wall_two+=t.wall_two;
+        finalists+=t.finalists;
+        audited+=t.audited;
+        missed+=t.missed;
+        correlation+=t.rank_correlation;
+    }
+    int G=telemetry.size();
+    os << "stage one took " << cpu_one << " s of CPU (" << wall_one << " s wall), stage two "
+       << cpu_two << " s of CPU (" << wall_two << " s wall)" << endl;
+    os << "finalists per generation " << double(finalists)/G << ", audited " << double(audited)/G
+       << ", audited strategies which made the cut " << missed << " of " << audited << endl;
+    os << "mean rank correlation of the stages " << correlation/G << endl;
+}
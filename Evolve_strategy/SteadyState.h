@@ -0,0 +1,334 @@
+/**
+
+ SteadyState evolves the population without generations. In Evolve
+ every generation waits until all of its strategies are played before
+ breeding the next one, so the threads are idle while the slowest
+ strategies finish and while the new generation is bred. Here the worker
+ threads never wait for each other: a worker which is done playing a
+ strategy breeds a new offspring right away from the strategies already
+ played, plays it, and puts it into the pool.
+
+ The pool holds at most M strategies with their fit scores, sorted from
+ the most fit. Parents are picked from the 'select' most fit in the pool
+ with the probability proportional to their fit score, and the offspring
+ is produced by the same crossover and mutation as in Evolve::offspring().
+ Once the pool is full, each new strategy retires the least fit one.
+
+ Evolve plays all its strategies again every generation, so a strategy
+ which was lucky once loses its score at the next generation. Here the
+ 'select' most fit in the pool are played again at the end of every
+ generation equivalent (see below): the workers play these replays
+ before they breed anything new, and the new score of a strategy which
+ is still in the pool replaces its old one. Without the replays the
+ most fit of the pool would be the luckiest single samples so far, and
+ their mean could only grow.
+
+ The initial strategies are handed out first. Once all of them are
+ handed out and 'select' of them are played, the workers start breeding,
+ while the last of the initial strategies are still playing.
+
+ The scores are reported in generation equivalents: Evolve plays M
+ strategies in the first generation and fill=M-select new ones in each
+ of the following, so the generation 'g' is over once M+g*fill new
+ strategies have been played (the replays are not counted). Its score is
+ the mean fit score of the 'select' most fit in the pool at that moment,
+ the counterpart of the one returned by Evolve::new_generation(). It is
+ close to, but not the same as, the score of Evolve: the scores of the
+ pool were played at different times, the most fit of them at most one
+ generation equivalent ago, while in Evolve they are all played in the
+ same generation.
+
+ Breeding needs two parents, so the pool must hold at least two
+ strategies; evolve() refuses to run with less.
+
+ */
+
+using namespace std;
+
+class SteadyState{
+public:
+    // Constructor takes as an argument initial bankrolls for player
+    // and dealer, bet size, propagation rate, selection rate, size of
+    // the pool, number of rounds played and number of worker threads.
+    // The initial strategies are random.
+    SteadyState(int, int, int, double, double, int, int, int);
+    // Constructor which also initializes the initial strategies to the
+    // given one.
+    SteadyState(int, int, int, double, double, int, int, int, vector<int>);
+    // Evolve over the given number of generation equivalents.
+    void evolve(const int &);
+    // Mean strategy of the 'select' most fit in the pool, weighted by
+    // their fit scores, as one flattened vector.
+    vector<double> mean_chromosome();
+    // Save the mean strategy to the file, in the chrom.csv format.
+    void save(const string &);
+    // Interfaces to private variables.
+    vector<double> get_score_time_series(){
+        return score_time_series;
+    }
+    vector<double> get_fit_scores();
+private:
+    struct Member{
+        vector<int> chrom;
+        double score;
+        // Number of the strategy, by which its replay finds it.
+        long long id;
+    };
+    // Worker thread body.
+    void work(const unsigned &);
+    // Pick a parent among the 'select' most fit in the pool; the pool
+    // mutex is to be held.
+    int select_parent(mt19937 &);
+    // Put the member into the pool in the order of the scores and retire
+    // the least fit if the pool is full; the pool mutex is to be held.
+    void place(const Member &);
+    // Put the new played strategy into the pool, and end the generation
+    // equivalent if it is over; the pool mutex is to be held.
+    void insert(const vector<int> &, const double &);
+    // Replace the score of the replayed strategy, if it is still in the
+    // pool; the pool mutex is to be held.
+    void replace(const long long &, const double &);
+    // Initial player's bankroll.
+    int p;
+    // Initial dealer's bankroll.
+    int d;
+    // Bet size.
+    int b;
+    // Propagation rate, the probability to pass the gene identical for
+    // both parents to the offspring without a mutation.
+    double propagate;
+    // Selection rate, the fraction of the most fit strategies which breed.
+    double selection_rate;
+    // Size of the pool.
+    int M;
+    // Number of rounds played used to calculate fit scores.
+    int R;
+    // Number of worker threads.
+    int workers;
+    // Number of the most fit which breed, and of the new strategies
+    // making one generation equivalent.
+    int select;
+    int fill;
+    // Strategies played first, and the number of them handed out.
+    vector<vector<int>> initial;
+    int next_initial;
+    // Pool sorted from the most fit, and its mutex; 'played' waits for
+    // the pool to get enough parents.
+    vector<Member> pool;
+    mutex pool_mutex;
+    condition_variable played;
+    // Number of the next new strategy, and the strategies of the pool
+    // waiting to be played again.
+    long long next_id;
+    deque<Member> replays;
+    // Number of strategies handed out to the workers, number of them
+    // played, and the number to play in total.
+    int issued;
+    int evaluated;
+    int total;
+    // Time series of the mean scores of the 'select' most fit.
+    vector<double> score_time_series;
+};
+
+SteadyState::SteadyState(int P, int D, int B, double prop, double sel_rate,
+                         int m, int r, int w){
+    p=P;
+    d=D;
+    b=B;
+    propagate=prop;
+    selection_rate=sel_rate;
+    M=m;
+    R=r;
+    workers=max(1,w);
+    for(int i=0;i<M;++i)
+        initial.push_back(Game(p,d,b).flatten());
+}
+
+SteadyState::SteadyState(int P, int D, int B, double prop, double sel_rate,
+                         int m, int r, int w, vector<int> chrom){
+    p=P;
+    d=D;
+    b=B;
+    propagate=prop;
+    selection_rate=sel_rate;
+    M=m;
+    R=r;
+    workers=max(1,w);
+    initial=vector<vector<int>>(M,chrom);
+}
+
+void SteadyState::evolve(const int & generations){
+    // Two parents are needed to breed, otherwise the workers would wait
+    // for the pool to get them forever.
+    if(M<2){
+        cerr << "The steady state evolution needs at least two strategies" << endl;
+        return;
+    }
+    select=max(2,int(selection_rate*M));
+    fill=max(1,M-select);
+    next_initial=0;
+    issued=0;
+    evaluated=0;
+    next_id=0;
+    replays.clear();
+    total=M+(generations-1)*fill;
+    vector<thread> threads;
+    for(int w=0;w<workers;++w)
+        threads.push_back(thread(&SteadyState::work,this,(unsigned) rand()));
+    for(thread & t : threads)
+        t.join();
+}
+
+int SteadyState::select_parent(mt19937 & engine){
+    int n=min(select,int(pool.size()));
+    double sum=0;
+    for(int i=0;i<n;++i)
+        sum+=pool[i].score;
+    // If all of them went bankrupt they are equally likely.
+    if(sum<=0)
+        return uniform_int_distribution<int>(0,n-1)(engine);
+    double r=uniform_real_distribution<double>(0.0,1.0)(engine)*sum;
+    double prev=0;
+    for(int i=0;i<n;++i){
+        prev+=pool[i].score;
+        if(r<prev)
+            return i;
+    }
+    return n-1;
+}
+
+void SteadyState::place(const Member & member){
+    // Members go after the equally fit ones already in the pool.
+    int k=0;
+    while(k<pool.size()&&pool[k].score>=member.score)
+        ++k;
+    pool.insert(pool.begin()+k,member);
+    if(pool.size()>M)
+        pool.pop_back();
+}
+
+void SteadyState::insert(const vector<int> & chrom, const double & score){
+    Member member={chrom,score,next_id++};
+    place(member);
+    evaluated++;
+    // Generation 'g' is over once M+g*fill strategies are played.
+    if(evaluated>=M&&(evaluated-M)%fill==0){
+        int n=min(select,int(pool.size()));
+        double scores_of_fit=0;
+        for(int i=0;i<n;++i)
+            scores_of_fit+=pool[i].score;
+        scores_of_fit/=n;
+        cout << "fit for generation " << (evaluated-M)/fill << " is " << scores_of_fit << endl;
+        score_time_series.push_back(scores_of_fit);
+        // Play the most fit again, as Evolve does every generation.
+        replays.clear();
+        for(int i=0;i<n;++i)
+            replays.push_back(pool[i]);
+    }
+}
+
+void SteadyState::replace(const long long & id, const double & score){
+    for(int k=0;k<pool.size();++k)
+        if(pool[k].id==id){
+            Member member=pool[k];
+            member.score=score;
+            pool.erase(pool.begin()+k);
+            place(member);
+            return;
+        }
+}
+
+void SteadyState::work(const unsigned & seed){
+    mt19937 engine(seed);
+    uniform_real_distribution<double> uniform(0.0,1.0);
+    while(true){
+        vector<int> chrom;
+        vector<int> parent_i;
+        vector<int> parent_j;
+        double fi=0;
+        double fj=0;
+        // Number of the strategy played again, -1 for a new one.
+        long long replay=-1;
+        {
+            unique_lock<mutex> lock(pool_mutex);
+            if(issued>=total)
+                return;
+            if(!replays.empty()){
+                chrom=replays.front().chrom;
+                replay=replays.front().id;
+                replays.pop_front();
+            }
+            else if(next_initial<initial.size())
+                chrom=initial[next_initial++];
+            else{
+                played.wait(lock,[this]{return pool.size()>=select;});
+                int i=select_parent(engine);
+                int j=select_parent(engine);
+                // make sure different parents are selected, even if only
+                // one of the 'select' most fit hasn't gone bankrupt.
+                for(int t=0;j==i&&t<100;++t)
+                    j=select_parent(engine);
+                if(j==i)
+                    j=(i+1)%select;
+                parent_i=pool[i].chrom;
+                parent_j=pool[j].chrom;
+                fi=pool[i].score;
+                fj=pool[j].score;
+            }
+            if(replay<0)
+                issued++;
+        }
+        if(chrom.empty()){
+            // Same crossover and mutation as in Evolve::offspring().
+            double prop_i=(fi+fj>0) ? fi/(fi+fj) : 0.5;
+            for(int k=0;k<parent_i.size();++k){
+                double r=uniform(engine);
+                if(parent_i[k]==parent_j[k])
+                    chrom.push_back((r<propagate) ? parent_i[k] : (parent_i[k]+1)%2);
+                else
+                    chrom.push_back((r<prop_i) ? parent_i[k] : parent_j[k]);
+            }
+        }
+        double score=fit_score(Game(p,d,b,chrom),R,p);
+        lock_guard<mutex> lock(pool_mutex);
+        if(replay>=0)
+            replace(replay,score);
+        else
+            insert(chrom,score);
+        played.notify_all();
+    }
+}
+
+vector<double> SteadyState::get_fit_scores(){
+    lock_guard<mutex> lock(pool_mutex);
+    vector<double> ret;
+    for(const Member & m : pool)
+        ret.push_back(m.score);
+    return ret;
+}
+
+vector<double> SteadyState::mean_chromosome(){
+    lock_guard<mutex> lock(pool_mutex);
+    int n=min(max(1,int(selection_rate*M)),int(pool.size()));
+    double tot_fit=0;
+    for(int i=0;i<n;++i)
+        tot_fit+=pool[i].score;
+    vector<double> chromosome(800,0);
+    for(int i=0;i<n;++i){
+        double weight=(tot_fit>0) ? pool[i].score/tot_fit : 1.0/n;
+        for(int k=0;k<pool[i].chrom.size();++k)
+            chromosome[k]+=weight*pool[i].chrom[k];
+    }
+    return chromosome;
+}
+
+void SteadyState::save(const string & file){
+    vector<double> chromosome=mean_chromosome();
+    ofstream file_chromosome(file);
+    int vsize=chromosome.size()-1;
+    for(int n=0;n<vsize;n++){
+        file_chromosome << chromosome[n];
+        file_chromosome << ",";
+    }
+    file_chromosome << chromosome[vsize];
+}
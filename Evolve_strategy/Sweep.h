@@ -0,0 +1,202 @@
+/**
+
+ Sweep runs many evolutions with different parameters at the same time,
+ all of them playing their populations on one shared ThreadPool, so that
+ the whole machine is used even if each evolution is small. The pool
+ serves the evolutions in turn (see ThreadPool.h). All evolutions play on
+ the decks seeded by the same common seed, so that in generation 'g' they
+ all play on the same sequence of shuffles, and their scores are
+ compared on the same cards.
+
+ The configurations are read from a file (sweep.csv by default), one per
+ line, as
+
+ propagation_rate,selection_rate,size_of_population,play_rounds,generations
+
+ Any of the entries can list several values separated by ';', in which
+ case the line stands for all combinations of the listed values (a grid).
+ For instance the line
+
+ 0.9999;0.999,0.05;0.1,1000,10000,100
+
+ stands for four configurations. Empty lines and lines starting with '#'
+ are skipped.
+
+ The results of all evolutions are saved to one file, sweep_results.csv,
+ one line per evolution: the five entries of its configuration, followed
+ by its score time series ('generations' entries), followed by the 800
+ entries of its mean strategy (same as saved in chrom.csv).
+
+ */
+
+using namespace std;
+
+struct SweepConfig{
+    double propagation_rate;
+    double selection_rate;
+    int size_of_population;
+    int play_rounds;
+    int generations;
+};
+
+// Input is to be a string with the name of the sweep configuration file.
+vector<SweepConfig> read_sweep(const string & file){
+    ifstream is(file);
+    string line;
+    vector<SweepConfig> configs;
+    while(getline(is,line)){
+        if(line.empty()||line[0]=='#')
+            continue;
+        // Split the line into entries, and each entry into its values.
+        vector<vector<double>> entries;
+        stringstream line_stream(line);
+        string entry;
+        while(getline(line_stream,entry,',')){
+            vector<double> values;
+            stringstream entry_stream(entry);
+            string value;
+            while(getline(entry_stream,value,';'))
+                values.push_back(stod(value));
+            entries.push_back(values);
+        }
+        if(entries.size()!=5){
+            cerr << "Skipping sweep line '" << line << "', it needs 5 entries" << endl;
+            continue;
+        }
+        // All combinations of the values, the last entry changing fastest.
+        vector<int> index(5,0);
+        while(true){
+            SweepConfig config;
+            config.propagation_rate=entries[0][index[0]];
+            config.selection_rate=entries[1][index[1]];
+            config.size_of_population=entries[2][index[2]];
+            config.play_rounds=entries[3][index[3]];
+            config.generations=entries[4][index[4]];
+            configs.push_back(config);
+            int k=4;
+            while(k>=0&&++index[k]==entries[k].size()){
+                index[k]=0;
+                k--;
+            }
+            if(k<0)
+                break;
+        }
+    }
+    return configs;
+}
+
+class Sweep{
+public:
+    // Constructor takes as an argument initial bankrolls for player and
+    // dealer, bet size, configurations, number of threads in the pool,
+    // and the common seed of the decks. All populations are initialized
+    // randomly.
+    Sweep(int, int, int, vector<SweepConfig>, int, unsigned);
+    // Constructor which also initializes all members of all populations
+    // to the given strategy.
+    Sweep(int, int, int, vector<SweepConfig>, int, unsigned, vector<int>);
+    // Run all evolutions and wait for them to finish.
+    void run();
+    // Save the results of all evolutions to the given file.
+    void save(const string &);
+    // Interfaces to private variables.
+    vector<vector<double>> get_score_time_series(){
+        return score_time_series;
+    }
+    vector<vector<double>> get_strategies(){
+        return strategies;
+    }
+private:
+    // Thread body driving the evolution 'k'; the Games are played
+    // on the pool.
+    void run_evolution(const int &, ThreadPool &);
+    // Initial player's bankroll.
+    int p;
+    // Initial dealer's bankroll.
+    int d;
+    // Bet size.
+    int b;
+    vector<SweepConfig> configs;
+    // Number of threads in the pool.
+    int threads;
+    // Common seed of the decks.
+    unsigned common_seed;
+    // Initial strategy, random if empty.
+    vector<int> chrom;
+    // Serializes printing to console.
+    mutex print_mutex;
+    // Score time series and mean strategy of each evolution.
+    vector<vector<double>> score_time_series;
+    vector<vector<double>> strategies;
+};
+
+Sweep::Sweep(int P, int D, int B, vector<SweepConfig> c, int t, unsigned seed){
+    p=P;
+    d=D;
+    b=B;
+    configs=c;
+    threads=t;
+    common_seed=seed;
+    chrom={};
+}
+
+Sweep::Sweep(int P, int D, int B, vector<SweepConfig> c, int t, unsigned seed,
+             vector<int> ch){
+    p=P;
+    d=D;
+    b=B;
+    configs=c;
+    threads=t;
+    common_seed=seed;
+    chrom=ch;
+}
+
+void Sweep::run(){
+    score_time_series=vector<vector<double>>(configs.size());
+    strategies=vector<vector<double>>(configs.size());
+    ThreadPool pool(threads);
+    // The drivers only wait for the pool and breed new generations,
+    // the Games are played by the pool threads.
+    vector<thread> drivers;
+    for(int k=0;k<configs.size();++k)
+        drivers.push_back(thread(&Sweep::run_evolution,this,k,ref(pool)));
+    for(thread & t : drivers)
+        t.join();
+    pool.report(cout);
+}
+
+void Sweep::run_evolution(const int & k, ThreadPool & pool){
+    const SweepConfig & c=configs[k];
+    PoolEvaluator evaluator(pool,common_seed);
+    unique_ptr<Evolve> ev;
+    if(chrom.empty())
+        ev.reset(new Evolve(p,d,b,c.propagation_rate,c.selection_rate,
+                            c.size_of_population,c.play_rounds,&evaluator));
+    else
+        ev.reset(new Evolve(p,d,b,c.propagation_rate,c.selection_rate,
+                            c.size_of_population,c.play_rounds,chrom,&evaluator));
+    for(int g=0;g<c.generations;++g){
+        ev->update_fit_scores();
+        double mean_fit=ev->new_generation();
+        score_time_series[k].push_back(mean_fit);
+        lock_guard<mutex> lock(print_mutex);
+        cout << "evolution " << k << ": fit for generation " << g << " is " << mean_fit << endl;
+    }
+    ev->update_fit_scores();
+    strategies[k]=ev->mean_chromosome();
+}
+
+void Sweep::save(const string & file){
+    ofstream results(file);
+    for(int k=0;k<configs.size();++k){
+        const SweepConfig & c=configs[k];
+        results << c.propagation_rate << "," << c.selection_rate << ","
+                << c.size_of_population << "," << c.play_rounds << ","
+                << c.generations;
+        for(double s : score_time_series[k])
+            results << "," << s;
+        for(double g : strategies[k])
+            results << "," << g;
+        results << endl;
+    }
+}
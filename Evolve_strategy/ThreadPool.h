@@ -0,0 +1,365 @@
+/**
+
+ ThreadPool is a pool of worker threads shared by several clients, for
+ instance by all the evolutions of a parameter sweep (see Sweep.h).
+
+ A client hands a batch of tasks to the pool with run(), which returns
+ once all of them are done. The tasks wait in the queue of their client,
+ and the clients are served in turn: a worker which has nothing to do
+ takes a chunk of tasks from the next client with waiting tasks, so a
+ client with a large batch doesn't hold up the others. The chunk is the
+ number of waiting tasks of the client divided by twice the number of
+ workers, so that the chunks are large while there is plenty of work,
+ and get down to a single task at the end of a batch.
+
+ Each worker keeps the chunk it took in its own deque, taking the tasks
+ from the front. A worker which finds its own deque empty and no client
+ with waiting tasks steals the back half of the deque of another worker
+ (the last task too, if only one is left), so that the last tasks of a
+ batch are spread over all workers. This matters because the tasks don't
+ take equally long: a strategy which goes bankrupt stops early, while a
+ good one plays all its rounds, and splitting makes the rounds longer.
+
+ Each worker measures the time it spends running tasks (busy) and the
+ time it spends looking for or waiting for the tasks (idle), see report().
+
+ PoolEvaluator is the Evaluator which plays the population on the pool.
+ For each generation it keeps the wall time of the evaluation and the
+ total time the tasks took. The total time divided by the number of
+ workers is the best possible wall time, so their ratio (the balance)
+ shows how well the work was spread over the workers.
+
+ If it is given a common seed, all Games of generation 'g' play the cards
+ of the deck seeded by the same seed made out of the common seed and 'g'.
+ The Evolve objects which use the same common seed then play on the same
+ sequences of shuffles (common random numbers), within a generation and
+ across the evolutions.
+
+ If it is given a shoe bank (see ShoeBank.h), the Games play the shoes of
+ the bank instead of shuffling. Each Game gets a range of R+1 shoes, as
+ many as it can use in R rounds, starting at the shoe picked by the seed
+ of the generation if there is a common seed (so all Games of a
+ generation play the same shoes), or at a random shoe otherwise.
+
+ */
+
+using namespace std;
+
+class ThreadPool{
+public:
+    // Constructor takes the number of worker threads.
+    ThreadPool(int);
+    // Stops and joins the worker threads.
+    ~ThreadPool();
+    // Registers a new client and returns its id.
+    int add_client();
+    // Run the tasks of the given client, returns when all of them are done.
+    void run(const int &, vector<function<void()>> &);
+    // Print the busy and idle time of each worker since the pool started.
+    void report(ostream &);
+    // Interfaces to private variables.
+    int get_workers(){
+        return workers;
+    }
+    vector<double> get_busy();
+    vector<double> get_idle();
+private:
+    // Batch of tasks handed over by run(), counting the unfinished tasks.
+    struct Batch{
+        int remaining;
+        mutex m;
+        condition_variable finished;
+    };
+    struct Task{
+        function<void()> * f;
+        Batch * batch;
+    };
+    // Worker thread body.
+    void work(const int &);
+    // Move a chunk of tasks of the next client into the deque of worker 'w',
+    // the chunk getting smaller as the client runs out of tasks.
+    bool take_chunk(const int &);
+    // Move the back half of another worker's deque into the deque of 'w'.
+    bool steal(const int &);
+    // Number of worker threads.
+    int workers;
+    // Deques of the workers, each with its own mutex, which also guards
+    // the busy and idle time (in seconds) of the worker.
+    vector<deque<Task>> local;
+    vector<unique_ptr<mutex>> local_mutex;
+    vector<double> busy;
+    vector<double> idle;
+    // Queues of the clients, the next client to be served, and the number
+    // of tasks which have not been started yet.
+    vector<deque<Task>> clients;
+    int next_client;
+    int waiting;
+    mutex clients_mutex;
+    condition_variable work_available;
+    bool stop;
+    vector<thread> threads;
+};
+
+ThreadPool::ThreadPool(int w){
+    workers=max(1,w);
+    local=vector<deque<Task>>(workers);
+    busy=vector<double>(workers,0);
+    idle=vector<double>(workers,0);
+    for(int i=0;i<workers;++i)
+        local_mutex.push_back(unique_ptr<mutex>(new mutex));
+    next_client=0;
+    waiting=0;
+    stop=false;
+    for(int i=0;i<workers;++i)
+        threads.push_back(thread(&ThreadPool::work,this,i));
+}
+
+ThreadPool::~ThreadPool(){
+    {
+        lock_guard<mutex> lock(clients_mutex);
+        stop=true;
+    }
+    work_available.notify_all();
+    for(thread & t : threads)
+        t.join();
+}
+
+int ThreadPool::add_client(){
+    lock_guard<mutex> lock(clients_mutex);
+    clients.push_back(deque<Task>());
+    return clients.size()-1;
+}
+
+void ThreadPool::run(const int & client, vector<function<void()>> & tasks){
+    if(tasks.empty())
+        return;
+    Batch batch;
+    batch.remaining=tasks.size();
+    {
+        lock_guard<mutex> lock(clients_mutex);
+        for(function<void()> & f : tasks){
+            Task task={&f,&batch};
+            clients[client].push_back(task);
+        }
+        waiting+=tasks.size();
+    }
+    work_available.notify_all();
+    unique_lock<mutex> lock(batch.m);
+    batch.finished.wait(lock,[&batch]{return batch.remaining==0;});
+}
+
+bool ThreadPool::take_chunk(const int & w){
+    lock_guard<mutex> lock(clients_mutex);
+    for(int k=0;k<clients.size();++k){
+        int c=(next_client+k)%clients.size();
+        if(clients[c].empty())
+            continue;
+        next_client=(c+1)%clients.size();
+        int chunk=max(1,int(clients[c].size())/(2*workers));
+        lock_guard<mutex> local_lock(*local_mutex[w]);
+        for(int i=0;i<chunk;++i){
+            local[w].push_back(clients[c].front());
+            clients[c].pop_front();
+        }
+        return true;
+    }
+    return false;
+}
+
+bool ThreadPool::steal(const int & w){
+    for(int k=1;k<workers;++k){
+        int v=(w+k)%workers;
+        deque<Task> stolen;
+        {
+            lock_guard<mutex> lock(*local_mutex[v]);
+            int n=(local[v].size()+1)/2;
+            for(int i=0;i<n;++i){
+                stolen.push_front(local[v].back());
+                local[v].pop_back();
+            }
+        }
+        if(stolen.empty())
+            continue;
+        lock_guard<mutex> lock(*local_mutex[w]);
+        for(Task & t : stolen)
+            local[w].push_back(t);
+        return true;
+    }
+    return false;
+}
+
+void ThreadPool::work(const int & w){
+    chrono::steady_clock::time_point since=chrono::steady_clock::now();
+    while(true){
+        Task task={nullptr,nullptr};
+        {
+            lock_guard<mutex> lock(*local_mutex[w]);
+            chrono::steady_clock::time_point now=chrono::steady_clock::now();
+            idle[w]+=chrono::duration<double>(now-since).count();
+            since=now;
+            if(!local[w].empty()){
+                task=local[w].front();
+                local[w].pop_front();
+            }
+        }
+        if(task.f==nullptr){
+            if(take_chunk(w)||steal(w))
+                continue;
+            unique_lock<mutex> lock(clients_mutex);
+            if(stop)
+                return;
+            // If tasks are still waiting they are in the deques of other
+            // workers, which are about to take them, so only look again
+            // shortly. Otherwise sleep until run() hands over new tasks.
+            if(waiting>0)
+                work_available.wait_for(lock,chrono::milliseconds(1));
+            else
+                work_available.wait(lock,[this]{return stop||waiting>0;});
+            continue;
+        }
+        {
+            lock_guard<mutex> lock(clients_mutex);
+            waiting--;
+        }
+        (*task.f)();
+        {
+            lock_guard<mutex> lock(*local_mutex[w]);
+            chrono::steady_clock::time_point now=chrono::steady_clock::now();
+            busy[w]+=chrono::duration<double>(now-since).count();
+            since=now;
+        }
+        lock_guard<mutex> lock(task.batch->m);
+        if(--task.batch->remaining==0)
+            task.batch->finished.notify_all();
+    }
+}
+
+vector<double> ThreadPool::get_busy(){
+    vector<double> ret;
+    for(int w=0;w<workers;++w){
+        lock_guard<mutex> lock(*local_mutex[w]);
+        ret.push_back(busy[w]);
+    }
+    return ret;
+}
+
+vector<double> ThreadPool::get_idle(){
+    vector<double> ret;
+    for(int w=0;w<workers;++w){
+        lock_guard<mutex> lock(*local_mutex[w]);
+        ret.push_back(idle[w]);
+    }
+    return ret;
+}
+
+void ThreadPool::report(ostream & os){
+    vector<double> b=get_busy();
+    vector<double> i=get_idle();
+    double tot_busy=0;
+    double tot=0;
+    for(int w=0;w<workers;++w){
+        os << "worker " << w << " busy " << b[w] << " s, idle " << i[w] << " s" << endl;
+        tot_busy+=b[w];
+        tot+=b[w]+i[w];
+    }
+    if(tot>0)
+        os << "workers were busy " << 100*tot_busy/tot << "% of the time" << endl;
+}
+
+class PoolEvaluator : public Evaluator{
+public:
+    // Constructor takes the pool and the common seed, zero meaning
+    // that the decks are not seeded.
+    PoolEvaluator(ThreadPool &, unsigned);
+    // Fit scores of the population, played on the pool.
+    vector<double> evaluate(vector<Game> &, const int &, const int &);
+    // Print the mean balance over the generations.
+    void report(ostream &);
+    // Interfaces to private variables.
+    vector<double> get_wall_times(){
+        return wall_times;
+    }
+    vector<double> get_task_times(){
+        return task_times;
+    }
+    // Continue the seeds after the given number of evaluations, used when
+    // the run is resumed from a checkpoint.
+    void set_generation(const int & g){
+        generation=g;
+    }
+    // Play the shoes of the given bank, nullptr to shuffle again. The bank
+    // must outlive the evaluator.
+    void set_shoe_bank(ShoeBank * b){
+        bank=b;
+    }
+private:
+    ThreadPool & pool;
+    int client;
+    unsigned common_seed;
+    // Number of generations evaluated so far.
+    int generation;
+    // Shoe bank the Games play, if any.
+    ShoeBank * bank;
+    // Wall time of each evaluation, and the total time of its tasks.
+    vector<double> wall_times;
+    vector<double> task_times;
+};
+
+PoolEvaluator::PoolEvaluator(ThreadPool & tp, unsigned seed) : pool(tp){
+    client=pool.add_client();
+    common_seed=seed;
+    generation=0;
+    bank=nullptr;
+}
+
+vector<double> PoolEvaluator::evaluate(vector<Game> & population, const int & R, const int & p){
+    unsigned shoe_seed=0;
+    if(common_seed!=0){
+        seed_seq seq{common_seed,(unsigned) generation};
+        seq.generate(&shoe_seed,&shoe_seed+1);
+    }
+    generation++;
+    vector<double> scores(population.size());
+    vector<double> times(population.size());
+    vector<function<void()>> tasks;
+    for(int i=0;i<population.size();++i){
+        // Shoes of the bank played by the Game, picked here as rand() is
+        // not to be called from the pool.
+        const unsigned char * shoes=nullptr;
+        unsigned long long count=R+1;
+        if(bank!=nullptr)
+            shoes=bank->shoes(shoe_seed!=0 ? shoe_seed : rand(),count);
+        int cards=(bank!=nullptr) ? bank->cards() : 0;
+        tasks.push_back([&population,&scores,&times,shoe_seed,shoes,cards,count,i,R,p]{
+            chrono::steady_clock::time_point start=chrono::steady_clock::now();
+            Game game=population[i];
+            if(shoes!=nullptr)
+                game.use_bank(shoes,cards,count);
+            else if(shoe_seed!=0)
+                game.seed(shoe_seed);
+            scores[i]=fit_score(game,R,p);
+            times[i]=chrono::duration<double>(chrono::steady_clock::now()-start).count();
+        });
+    }
+    chrono::steady_clock::time_point start=chrono::steady_clock::now();
+    pool.run(client,tasks);
+    wall_times.push_back(chrono::duration<double>(chrono::steady_clock::now()-start).count());
+    double tot=0;
+    for(double t : times)
+        tot+=t;
+    task_times.push_back(tot);
+    return scores;
+}
+
+void PoolEvaluator::report(ostream & os){
+    double wall=0;
+    double tot=0;
+    for(int g=0;g<wall_times.size();++g){
+        wall+=wall_times[g];
+        tot+=task_times[g];
+    }
+    if(wall>0)
+        os << "evaluation took " << wall << " s, best possible on "
+           << pool.get_workers() << " workers is " << tot/pool.get_workers()
+           << " s, balance " << 100*tot/pool.get_workers()/wall << "%" << endl;
+}
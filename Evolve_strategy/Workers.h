@@ -0,0 +1,264 @@
+/**
+
+ Workers is the Evaluator which plays the population in N worker
+ processes forked by the coordinator (the process running Evolve).
+
+ The coordinator and the workers share one memory region, mapped before
+ the workers are forked, which holds the population packed into 100 bytes
+ per chromosome (see pack_chromosome() in Chromosome.h), the fit scores,
+ and the state of each evaluation job. The coordinator writes the packed
+ population into the region and posts one unit of the shared semaphore
+ per job. A worker woken by the semaphore claims a job by writing its
+ process id into the job state, plays the chromosome straight from the
+ shared region, and writes the fit score back next to it. Nothing is
+ copied between the processes.
+
+ While waiting for the jobs to finish the coordinator counts the jobs
+ whose state says they are done, and checks whether any worker has died.
+ The jobs claimed by a dead worker are put back into the queue and a new
+ worker is forked in its place, so a crash of one worker only costs the
+ evaluation of the chromosome it was playing.
+
+ The decks are seeded and the shoe bank played as in PoolEvaluator (see
+ ThreadPool.h): with a common seed all Games of generation 'g' play the
+ deck, or the shoes of the bank, picked by the seed made out of the
+ common seed and 'g', which the coordinator writes into the shared region
+ with each batch, so a resumed run continues exactly. The bank is given
+ to the constructor, as it has to be mapped before the workers are forked.
+
+ If the population is larger than the shared region it is evaluated in
+ several batches. Uses POSIX shared memory and semaphores, Linux only.
+
+ */
+
+using namespace std;
+
+// Header of the shared memory region.
+struct WorkersShared{
+    // One unit per job waiting to be claimed, shared between processes.
+    sem_t jobs_available;
+    // Set when the workers should exit.
+    atomic<int> stop;
+    // Number of jobs in the current batch, number of rounds played,
+    // initial bankrolls and bet size.
+    int jobs;
+    int rounds;
+    int p;
+    int d;
+    int b;
+    // Seed of the decks of the batch, zero to shuffle them, and whether
+    // all jobs play the deck of the seed or job 'i' the shoes of the bank
+    // picked by seed+i (a random seed without the common seed).
+    unsigned seed;
+    int common;
+};
+
+class Workers : public Evaluator{
+public:
+    // Constructor takes the number of worker processes, the number of
+    // chromosomes the shared region can hold, the common seed, zero
+    // meaning that the decks are not seeded, and the shoe bank to play,
+    // nullptr to shuffle. The bank must outlive the workers.
+    Workers(int, int, unsigned=0, ShoeBank * =nullptr);
+    // Stops the workers and unmaps the shared region.
+    ~Workers();
+    // Fit scores of the population, played by the worker processes.
+    vector<double> evaluate(vector<Game> &, const int &, const int &);
+    // Interfaces to private variables.
+    vector<pid_t> get_pids(){
+        return pids;
+    }
+    int get_requeued(){
+        return requeued;
+    }
+    // Continue the seeds after the given number of evaluations, used when
+    // the run is resumed from a checkpoint.
+    void set_generation(const int & g){
+        generation=g;
+    }
+private:
+    // Fork the worker with the given index.
+    void start_worker(const int &);
+    // Body of the worker process, never returns.
+    void work();
+    // Number of the first given jobs which are done, counted from their
+    // states, so that a worker dying at any point can't lose the count.
+    int finished(const int &);
+    // Put the jobs claimed by the dead worker back into the queue,
+    // and replace the worker.
+    void requeue(const pid_t &);
+    // Number of worker processes.
+    int N;
+    // Number of chromosomes the shared region can hold.
+    int capacity;
+    // Shared region and its parts.
+    void * region;
+    size_t region_size;
+    WorkersShared * shared;
+    // Job state: 0 waiting, process id of the worker playing it,
+    // or -1 if finished.
+    atomic<int> * state;
+    double * fitness;
+    unsigned char * genomes;
+    // Worker process ids.
+    vector<pid_t> pids;
+    // Number of jobs put back into the queue after a worker died.
+    int requeued;
+    unsigned common_seed;
+    // Number of generations evaluated so far.
+    int generation;
+    // Shoe bank the Games play, if any.
+    ShoeBank * bank;
+};
+
+Workers::Workers(int n, int c, unsigned seed, ShoeBank * b){
+    N=max(1,n);
+    capacity=max(1,c);
+    requeued=0;
+    common_seed=seed;
+    generation=0;
+    bank=b;
+    // Each part starts at a multiple of 64 bytes.
+    size_t header=(sizeof(WorkersShared)+63)/64*64;
+    size_t states=(capacity*sizeof(atomic<int>)+63)/64*64;
+    size_t scores=(capacity*sizeof(double)+63)/64*64;
+    region_size=header+states+scores+capacity*100;
+    region=mmap(nullptr,region_size,PROT_READ|PROT_WRITE,MAP_SHARED|MAP_ANONYMOUS,-1,0);
+    if(region==MAP_FAILED){
+        cerr << "Workers: cannot map the shared region" << endl;
+        exit(1);
+    }
+    char * base=(char *) region;
+    shared=new (base) WorkersShared;
+    state=(atomic<int> *) (base+header);
+    for(int i=0;i<capacity;++i)
+        new (state+i) atomic<int>(-1);
+    fitness=(double *) (base+header+states);
+    genomes=(unsigned char *) (base+header+states+scores);
+    sem_init(&shared->jobs_available,1,0);
+    shared->stop=0;
+    shared->jobs=0;
+    // Flush the console so that the workers don't inherit the buffered output.
+    cout.flush();
+    pids=vector<pid_t>(N,0);
+    for(int w=0;w<N;++w)
+        start_worker(w);
+}
+
+Workers::~Workers(){
+    shared->stop=1;
+    for(int w=0;w<N;++w)
+        sem_post(&shared->jobs_available);
+    for(pid_t pid : pids)
+        waitpid(pid,nullptr,0);
+    sem_destroy(&shared->jobs_available);
+    munmap(region,region_size);
+}
+
+void Workers::start_worker(const int & w){
+    pid_t pid=fork();
+    if(pid==0)
+        work();
+    pids[w]=pid;
+}
+
+void Workers::work(){
+    int me=getpid();
+    while(true){
+        if(sem_wait(&shared->jobs_available)!=0)
+            continue;
+        if(shared->stop)
+            _exit(0);
+        // Claim the first waiting job.
+        for(int i=0;i<shared->jobs;++i){
+            int waiting=0;
+            if(!state[i].compare_exchange_strong(waiting,me))
+                continue;
+            Game game(shared->p,shared->d,shared->b,unpack_chromosome(genomes+100*i));
+            if(bank!=nullptr){
+                unsigned long long count=shared->rounds+1;
+                const unsigned char * shoes=bank->shoes(shared->common ? shared->seed
+                                                        : shared->seed+i,count);
+                game.use_bank(shoes,bank->cards(),count);
+            }
+            else if(shared->seed!=0)
+                game.seed(shared->seed);
+            fitness[i]=fit_score(game,shared->rounds,shared->p);
+            // The fit score is written before the job is marked done, and
+            // the job is done only once it is marked.
+            state[i]=-1;
+            break;
+        }
+    }
+}
+
+int Workers::finished(const int & jobs){
+    int n=0;
+    for(int i=0;i<jobs;++i)
+        if(state[i]==-1)
+            n++;
+    return n;
+}
+
+void Workers::requeue(const pid_t & pid){
+    for(int i=0;i<shared->jobs;++i){
+        int claimed=pid;
+        if(state[i].compare_exchange_strong(claimed,0)){
+            requeued++;
+            sem_post(&shared->jobs_available);
+        }
+    }
+    // The worker could also have died after taking a unit of the semaphore
+    // but before claiming a job. Make sure there are at least as many units
+    // as waiting jobs, an extra unit only makes a worker look for a job
+    // once more.
+    int waiting=0;
+    for(int i=0;i<shared->jobs;++i)
+        if(state[i]==0)
+            waiting++;
+    int units;
+    sem_getvalue(&shared->jobs_available,&units);
+    for(;units<waiting;++units)
+        sem_post(&shared->jobs_available);
+    for(int w=0;w<N;++w)
+        if(pids[w]==pid)
+            start_worker(w);
+}
+
+vector<double> Workers::evaluate(vector<Game> & population, const int & R, const int & p){
+    unsigned shoe_seed=0;
+    if(common_seed!=0){
+        seed_seq seq{common_seed,(unsigned) generation};
+        seq.generate(&shoe_seed,&shoe_seed+1);
+    }
+    generation++;
+    vector<double> scores;
+    for(int start=0;start<population.size();start+=capacity){
+        int jobs=min(capacity,int(population.size())-start);
+        for(int i=0;i<jobs;++i){
+            pack_chromosome(population[start+i].flatten(),genomes+100*i);
+            state[i]=0;
+        }
+        shared->jobs=jobs;
+        shared->rounds=R;
+        shared->p=p;
+        shared->d=population[start].get_dealer_bankroll();
+        shared->b=population[start].get_bet_size();
+        shared->common=shoe_seed!=0;
+        shared->seed=(shoe_seed!=0||bank==nullptr) ? shoe_seed : rand();
+        for(int i=0;i<jobs;++i)
+            sem_post(&shared->jobs_available);
+        while(finished(jobs)<jobs){
+            int status;
+            pid_t dead=waitpid(-1,&status,WNOHANG);
+            if(dead>0){
+                cerr << "Workers: worker " << dead << " died, requeueing its jobs" << endl;
+                requeue(dead);
+                continue;
+            }
+            this_thread::sleep_for(chrono::milliseconds(1));
+        }
+        copy(fitness,fitness+jobs,back_inserter(scores));
+    }
+    return scores;
+}
@@ -0,0 +1,44 @@
+// This file converts a strategy between the CSV files
+// (strategy_chromosome.csv, chrom.csv) and the binary .bjs
+// files, see 'StrategyFile.h' for the format. The direction
+// is given by the extension of the first argument:
+//
+// convert_strategy strategy_chromosome.csv strategy_chromosome.bjs
+// convert_strategy chrom.bjs chrom.csv
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <fstream>
+#include <iterator>
+#include <cstring>
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#endif
+
+#include "../Common/StrategyFile.h"
+
+using namespace std;
+
+int main(int argc, char * argv[]){
+    if(argc<3){
+        cerr << "Usage: convert_strategy input output" << endl;
+        return 1;
+    }
+    string input=argv[1];
+    string output=argv[2];
+    bool ok;
+    if(is_strategy_file(input))
+        ok=strategy_to_csv(input,output);
+    else
+        ok=csv_to_strategy(input,output);
+    if(!ok){
+        cerr << "Cannot convert " << input << " to " << output << endl;
+        return 1;
+    }
+    return 0;
+}
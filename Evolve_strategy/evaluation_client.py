@@ -0,0 +1,76 @@
+'''
+Client for the evaluation server (see evaluation_server.cpp for the
+protocol).
+
+evaluate() sends the list of strategies (chromosomes, each a list of
+800 entries 0/1) to the server and returns the lists of their fit
+scores, edges and variances of a round, played under the rules with the
+given number (see RulesRegistry.h, 0 for the rules of Game.h).
+The bet must be a multiple of the bet_multiple of the rules, for
+instance of 5 for the natural paying 6 to 5 (rules 3), or the server
+rejects the request.
+
+Run as a script it evaluates the strategy in strategy_chromosome.csv
+and prints the results to console.
+'''
+
+from __future__ import print_function
+import csv
+import socket
+import struct
+
+MAGIC=0x56454a42
+VERSION=1
+# Mode flags.
+NO_CUTOFF=1
+COMMON_CARDS=2
+
+###########################################################################
+
+def pack_chromosome(chromosome):
+    # Gene k is the bit k%8 of the byte k/8, same as pack_chromosome()
+    # in Chromosome.h.
+    packed=bytearray(100)
+    for k,g in enumerate(chromosome):
+        if int(g)==1:
+            packed[k//8]|=1<<(k%8)
+    return bytes(packed)
+
+def receive(sock,size):
+    data=b''
+    while len(data)<size:
+        chunk=sock.recv(size-len(data))
+        if not chunk:
+            raise IOError("evaluation server closed the connection")
+        data+=chunk
+    return data
+
+def evaluate(chromosomes,rounds=10000,seed=0,mode=0,player_bankroll=10000,
+             dealer_bankroll=10000,bet=2,path="/tmp/blackjack_evaluation.sock",
+             rules=0):
+    n=len(chromosomes)
+    request=struct.pack('<IIIIQIIiii',MAGIC,VERSION,n,rounds,seed,mode,rules,
+                        player_bankroll,dealer_bankroll,bet)
+    request+=b''.join(pack_chromosome(c) for c in chromosomes)
+    sock=socket.socket(socket.AF_UNIX,socket.SOCK_STREAM)
+    sock.connect(path)
+    sock.sendall(request)
+    magic,status,m=struct.unpack('<III',receive(sock,12))
+    if magic!=MAGIC or status!=0:
+        sock.close()
+        raise ValueError("evaluation server rejected the request")
+    values=struct.unpack('<{}d'.format(3*m),receive(sock,24*m))
+    sock.close()
+    return list(values[:m]),list(values[m:2*m]),list(values[2*m:])
+
+###########################################################################
+
+if __name__=='__main__':
+    with open('strategy_chromosome.csv', 'r') as file:
+        reader = csv.reader(file)
+        chromosome = list(reader)
+    chromosome=[int(float(x)) for x in chromosome[0]]
+    fitness,edges,variances=evaluate([chromosome],mode=NO_CUTOFF)
+    print("Fit score is {}".format(fitness[0]))
+    print("Player's edge is {}".format(edges[0]))
+    print("Variance of a round is {}".format(variances[0]))
@@ -0,0 +1,336 @@
+/**
+
+ evaluation_server.cpp is a long-lived server which evaluates batches of
+ strategies for other tools, so that they don't need to recompile anything
+ or to rewrite strategy_chromosome.csv. It listens on a Unix-domain socket,
+ by default /tmp/blackjack_evaluation.sock (or the first command line
+ argument), and keeps a pool of worker threads, one per core by default
+ (or the second command line argument).
+
+ Each strategy of a request is a separate job in the queue shared by all
+ clients, so the worker threads are kept busy by many small clients as
+ well as by one large one. A client may send several requests without
+ waiting for the responses (pipelining), the responses come back on the
+ same connection in the order of the requests.
+
+ All numbers are in the native (little-endian) byte order.
+
+ Request:
+
+ * uint32 magic, 0x56454a42 ("BJEV")
+ * uint32 version, 1
+ * uint32 number of strategies, n
+ * uint32 rounds played by each strategy
+ * uint64 seed; if zero, the decks are shuffled randomly, otherwise
+   strategy i plays the deck seeded by seed+i (or by seed, see mode)
+ * uint32 mode, sum of the flags:
+   1 - play all rounds, without stopping when the player or dealer goes
+       bankrupt (the fit score can then be negative),
+   2 - all strategies play the deck seeded by the same seed (common cards)
+ * uint32 rules, the number of the rules in the registry of RulesRegistry.h,
+   0 for the rules of Game.h
+ * int32 player's bankroll, int32 dealer's bankroll, int32 bet size, a
+   multiple of the bet_multiple of the rules (see RulesRegistry.h), for
+   instance of 5 for the natural paying 6 to 5
+ * n*100 bytes, strategies packed by pack_chromosome() (see Chromosome.h)
+
+ Response:
+
+ * uint32 magic, 0x56454a42
+ * uint32 status, 0 if OK, 1 if the request was not valid
+ * uint32 number of strategies, n (0 if not valid)
+ * n float64 fit scores, final bankroll over the initial one
+ * n float64 edges, mean result of a round in units of bet
+ * n float64 variances of the result of a round in units of bet
+
+ If the request is not valid the server responds and closes the connection.
+ See evaluation_client.py for the client.
+
+ */
+
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <fstream>
+#include <array>
+#include <random>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <sstream>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "Chromosome.h"
+#include "../Common/Deck.h"
+#include "../Common/HandState.h"
+#include "../Common/Rules.h"
+#include "../Common/Engine.h"
+#include "Game.h"
+#include "RulesRegistry.h"
+
+using namespace std;
+
+const unsigned MAGIC=0x56454a42;
+const unsigned VERSION=1;
+const int REQUEST_HEADER_SIZE=44;
+// Mode flags.
+const unsigned NO_CUTOFF=1;
+const unsigned COMMON_CARDS=2;
+// Largest number of strategies in one request.
+const unsigned MAX_STRATEGIES=1<<20;
+
+struct Request{
+    unsigned n;
+    unsigned rounds;
+    unsigned long long seed;
+    unsigned mode;
+    unsigned rules;
+    int p;
+    int d;
+    int b;
+    bool valid;
+    vector<unsigned char> genomes;
+    vector<double> fitness;
+    vector<double> edge;
+    vector<double> variance;
+    // Number of strategies still to be evaluated.
+    int remaining;
+    mutex m;
+    condition_variable finished;
+};
+
+// Read or write exactly the given number of bytes, false on error or end.
+bool read_full(int fd, void * buffer, size_t size){
+    char * b=(char *) buffer;
+    while(size>0){
+        ssize_t r=read(fd,b,size);
+        if(r<=0)
+            return false;
+        b+=r;
+        size-=r;
+    }
+    return true;
+}
+
+bool write_full(int fd, const void * buffer, size_t size){
+    const char * b=(const char *) buffer;
+    while(size>0){
+        ssize_t r=write(fd,b,size);
+        if(r<=0)
+            return false;
+        b+=r;
+        size-=r;
+    }
+    return true;
+}
+
+class Server{
+public:
+    // Constructor takes the socket path and the number of worker threads.
+    Server(const string &, int);
+    // Accept connections forever.
+    void run();
+private:
+    // Worker thread body.
+    void work();
+    // Play strategy 'i' of the request.
+    void evaluate(Request &, const int &);
+    // Reads the requests of one connection and queues their strategies.
+    void read_requests(int);
+    // Writes the responses of one connection in the order of requests.
+    void write_responses(int, deque<shared_ptr<Request>> &, mutex &,
+                         condition_variable &);
+    string path;
+    int threads;
+    // Strategies waiting to be evaluated, shared by all clients.
+    deque<pair<shared_ptr<Request>,int>> jobs;
+    mutex jobs_mutex;
+    condition_variable jobs_available;
+};
+
+Server::Server(const string & socket_path, int t){
+    path=socket_path;
+    threads=max(1,t);
+}
+
+void Server::run(){
+    int listener=socket(AF_UNIX,SOCK_STREAM,0);
+    sockaddr_un address;
+    memset(&address,0,sizeof(address));
+    address.sun_family=AF_UNIX;
+    strncpy(address.sun_path,path.c_str(),sizeof(address.sun_path)-1);
+    unlink(path.c_str());
+    if(listener<0||::bind(listener,(sockaddr *) &address,sizeof(address))!=0
+       ||listen(listener,64)!=0){
+        cerr << "Cannot listen on " << path << endl;
+        exit(1);
+    }
+    for(int t=0;t<threads;++t)
+        thread(&Server::work,this).detach();
+    cout << "Evaluating on " << threads << " threads, listening on " << path << endl;
+    for(const RulesVariant & variant : rules_registry())
+        cout << "Rules " << variant.number << " (" << variant.name << "): "
+             << variant.description << endl;
+    while(true){
+        int fd=accept(listener,nullptr,nullptr);
+        if(fd<0)
+            continue;
+        thread(&Server::read_requests,this,fd).detach();
+    }
+}
+
+void Server::work(){
+    while(true){
+        pair<shared_ptr<Request>,int> job;
+        {
+            unique_lock<mutex> lock(jobs_mutex);
+            jobs_available.wait(lock,[this]{return !jobs.empty();});
+            job=jobs.front();
+            jobs.pop_front();
+        }
+        Request & request=*job.first;
+        evaluate(request,job.second);
+        lock_guard<mutex> lock(request.m);
+        if(--request.remaining==0)
+            request.finished.notify_all();
+    }
+}
+
+void Server::evaluate(Request & request, const int & i){
+    const RulesVariant * rules=find_rules(request.rules);
+    bool cutoff=!(request.mode&NO_CUTOFF);
+    // Without the cutoff both start with enough to never go bankrupt,
+    // a round can't cost more than the most bets of the rules.
+    int extra=cutoff ? 0 : rules->max_bets*request.b*request.rounds;
+    // Play round by round to collect the result of each round.
+    RoundsPlayed played=rules->play(unpack_chromosome(&request.genomes[100*i]),
+                                    request.p+extra,request.d+extra,request.b,request.rounds,
+                                    request.seed!=0,
+                                    (request.mode&COMMON_CARDS) ? request.seed : request.seed+i,
+                                    nullptr,0,0);
+    int n=played.rounds;
+    double final_bankroll=played.bankroll-extra;
+    if(cutoff&&final_bankroll<=0)
+        request.fitness[i]=0;
+    else
+        request.fitness[i]=final_bankroll/request.p;
+    request.edge[i]=(n>0) ? played.sum/n : 0;
+    request.variance[i]=(n>1) ? (played.sum2-played.sum*played.sum/n)/(n-1) : 0;
+}
+
+void Server::read_requests(int fd){
+    deque<shared_ptr<Request>> pending;
+    mutex pending_mutex;
+    condition_variable pending_available;
+    thread writer(&Server::write_responses,this,fd,ref(pending),ref(pending_mutex),
+                  ref(pending_available));
+    while(true){
+        unsigned char header[REQUEST_HEADER_SIZE];
+        if(!read_full(fd,header,REQUEST_HEADER_SIZE))
+            break;
+        unsigned magic;
+        unsigned version;
+        shared_ptr<Request> request(new Request);
+        memcpy(&magic,header,4);
+        memcpy(&version,header+4,4);
+        memcpy(&request->n,header+8,4);
+        memcpy(&request->rounds,header+12,4);
+        memcpy(&request->seed,header+16,8);
+        memcpy(&request->mode,header+24,4);
+        memcpy(&request->rules,header+28,4);
+        memcpy(&request->p,header+32,4);
+        memcpy(&request->d,header+36,4);
+        memcpy(&request->b,header+40,4);
+        // The bet size must give whole payouts under the rules.
+        const RulesVariant * rules=find_rules(request->rules,request->b);
+        request->valid=magic==MAGIC&&version==VERSION&&request->n<=MAX_STRATEGIES
+            &&request->rounds>0&&rules!=nullptr&&request->p>0&&request->d>0&&request->b>0
+            &&1.0*rules->max_bets*request->b*request->rounds+request->p<INT_MAX/2
+            &&1.0*rules->max_bets*request->b*request->rounds+request->d<INT_MAX/2;
+        if(request->valid){
+            request->genomes=vector<unsigned char>(100*request->n);
+            if(!read_full(fd,request->genomes.data(),request->genomes.size()))
+                break;
+            request->fitness=vector<double>(request->n);
+            request->edge=vector<double>(request->n);
+            request->variance=vector<double>(request->n);
+            request->remaining=request->n;
+            lock_guard<mutex> lock(jobs_mutex);
+            for(int i=0;i<request->n;++i)
+                jobs.push_back(make_pair(request,i));
+            jobs_available.notify_all();
+        }
+        else
+            request->remaining=0;
+        {
+            lock_guard<mutex> lock(pending_mutex);
+            pending.push_back(request);
+            pending_available.notify_one();
+        }
+        if(!request->valid)
+            break;
+    }
+    // Null request tells the writer there is nothing more to come.
+    {
+        lock_guard<mutex> lock(pending_mutex);
+        pending.push_back(nullptr);
+        pending_available.notify_one();
+    }
+    writer.join();
+    close(fd);
+}
+
+void Server::write_responses(int fd, deque<shared_ptr<Request>> & pending,
+                             mutex & pending_mutex, condition_variable & pending_available){
+    bool connected=true;
+    while(true){
+        shared_ptr<Request> request;
+        {
+            unique_lock<mutex> lock(pending_mutex);
+            pending_available.wait(lock,[&pending]{return !pending.empty();});
+            request=pending.front();
+            pending.pop_front();
+        }
+        if(!request)
+            return;
+        {
+            unique_lock<mutex> lock(request->m);
+            request->finished.wait(lock,[&request]{return request->remaining==0;});
+        }
+        if(!connected)
+            continue;
+        unsigned header[3]={MAGIC,request->valid ? 0u : 1u,request->valid ? request->n : 0u};
+        connected=write_full(fd,header,sizeof(header));
+        if(connected&&request->valid){
+            connected=write_full(fd,request->fitness.data(),8*request->n)
+                &&write_full(fd,request->edge.data(),8*request->n)
+                &&write_full(fd,request->variance.data(),8*request->n);
+        }
+    }
+}
+
+int main(int argc, char * argv[]){
+    // Clients closing their connection early shouldn't stop the server.
+    signal(SIGPIPE,SIG_IGN);
+    string path="/tmp/blackjack_evaluation.sock";
+    if(argc>1)
+        path=argv[1];
+    int threads=thread::hardware_concurrency();
+    if(argc>2)
+        threads=atoi(argv[2]);
+    Server server(path,threads);
+    server.run();
+    return 0;
+}
@@ -0,0 +1,258 @@
+/**
+
+ library.cpp manages the strategy libraries (see Library.h) and plays all
+ strategies of a library against each other in one go (a tournament).
+
+ library add <library> <strategy file> [tags] [rules]
+     adds the strategies of the .bjs file (all of them) or of the CSV file
+     (strategy_chromosome.csv or chrom.csv, the mean rounded to 0 or 1)
+     to the library, with the given tags separated by ',', creating the
+     library if there is none. The strategies of a CSV file are for the
+     given rules, the name or the number of the rules in RulesRegistry.h
+     (0, the rules of Game.h, by default); those of a .bjs file keep the
+     rules stored with them,
+ library list <library> [tag]
+     prints the hash, the rules and the tags of each strategy (with the
+     given tag),
+ library play <library> [rounds] [threads] [seed] [tag] [shoe bank]
+     plays each strategy (with the given tag, "" for all) for the given
+     number of rounds, 10000 by default, on a pool of threads, one per
+     core by default. All strategies play the same cards, the decks seeded
+     by the given seed (1 by default), so their results are compared on
+     the same shuffles. If a shoe bank (.bjb, see ShoeBank.h) is given,
+     all strategies play the same shoes of the bank instead, picked by the
+     seed, so that tournaments run on different days play exactly the
+     same cards; the strategies for more decks than the shoes of the bank
+     have are left out. Each strategy is played under its own rules. The
+     results are written to library_results.csv, ranked by the edge, one
+     line per strategy: rank, number of the strategy in the library, hash,
+     rules, fit score, edge and variance of a round in units of bet, and
+     tags.
+
+ The fit score is the final bankroll over the initial one (10000, bet 2,
+ as in Evolve.cpp, or 5 under the rules whose natural pays 6 to 5), 0 if
+ the player went bankrupt. The edge and the variance are calculated over
+ all rounds, played without stopping when the player or the dealer goes
+ bankrupt, as in the mode 1 of the evaluation_server.cpp.
+
+ */
+
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <fstream>
+#include <array>
+#include <random>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <sstream>
+#include <map>
+#include <iterator>
+#include <iomanip>
+#include <thread>
+#include <mutex>
+#include <memory>
+#include <functional>
+#include <condition_variable>
+#include <deque>
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#endif
+
+#include "Chromosome.h"
+#include "../Common/StrategyFile.h"
+#include "../Common/ShoeBank.h"
+#include "../Common/Deck.h"
+#include "../Common/HandState.h"
+#include "../Common/Rules.h"
+#include "../Common/Engine.h"
+#include "Game.h"
+#include "RulesRegistry.h"
+#include "Evaluator.h"
+#include "ThreadPool.h"
+#include "Library.h"
+
+using namespace std;
+
+struct TournamentResult{
+    int entry;
+    double fitness;
+    double edge;
+    double variance;
+};
+
+// Play the strategy round by round under the given rules on the deck with
+// the given seed, as evaluation_server.cpp does, or on the given shoes of
+// a shoe bank if the bank is given.
+TournamentResult play_strategy(const vector<int> & chrom, const RulesVariant & rules,
+                               const int & rounds, const unsigned & seed, ShoeBank * bank,
+                               const unsigned char * shoes, const unsigned long long & count){
+    const int p=10000;
+    const int d=10000;
+    // The smallest bet of at least 2 which pays whole chips under the rules.
+    const int b=max(2,rules.bet_multiple);
+    // Without the cutoff both start with enough to never go bankrupt,
+    // a round can't cost more than the most bets of the rules.
+    int extra=rules.max_bets*b*rounds;
+    RoundsPlayed played=rules.play(chrom,p+extra,d+extra,b,rounds,true,seed,shoes,
+                                   bank ? bank->cards() : 0,count);
+    TournamentResult result;
+    result.entry=-1;
+    // The lowest bankroll tells whether the player went bankrupt.
+    result.fitness=(played.lowest-extra<=0) ? 0 : double(played.bankroll-extra)/p;
+    result.edge=played.sum/rounds;
+    result.variance=(rounds>1) ? (played.sum2-played.sum*played.sum/rounds)/(rounds-1) : 0;
+    return result;
+}
+
+// Name of the rules with the given number, or the number if they are not
+// in the registry.
+string rules_name(const unsigned & number){
+    const RulesVariant * rules=find_rules(number);
+    return rules ? rules->name : to_string(number);
+}
+
+int add(const string & library_file, const string & file, const string & tags,
+        const string & rules_name){
+    const RulesVariant * rules=find_rules(rules_name);
+    if(!rules){
+        cerr << "Unknown rules " << rules_name << endl;
+        return 1;
+    }
+    StrategyLibrary library(library_file);
+    int before=library.size();
+    if(is_strategy_file(file)){
+        MappedFile f(file);
+        for(const StrategyView & v : view_strategies(f.data(),f.size()))
+            library.add(v.chromosome(),tags,v.header->rules);
+    }
+    else{
+        string tmp=file+".bjs";
+        if(!csv_to_strategy(file,tmp)){
+            cerr << "Cannot read " << file << endl;
+            return 1;
+        }
+        library.add(load_strategy(tmp),tags,rules->number);
+        remove(tmp.c_str());
+    }
+    if(!library.save(library_file)){
+        cerr << "Cannot write " << library_file << endl;
+        return 1;
+    }
+    cout << library.size()-before << " new strategies, " << library.size()
+         << " in the library" << endl;
+    return 0;
+}
+
+int list(const string & library_file, const string & tag){
+    LibraryView library(library_file);
+    if(!library.valid()){
+        cerr << "Cannot read " << library_file << endl;
+        return 1;
+    }
+    vector<int> entries;
+    if(tag.empty())
+        for(int i=0;i<library.size();++i)
+            entries.push_back(i);
+    else
+        entries=library.with_tag(tag);
+    for(int i : entries)
+        cout << i << " " << hex << setw(16) << setfill('0') << library.hash(i)
+             << dec << " " << rules_name(library.rules(i)) << " " << library.tags(i) << endl;
+    return 0;
+}
+
+int play(const string & library_file, const int & rounds, const int & threads,
+         const unsigned & seed, const string & tag, const string & bank_file){
+    LibraryView library(library_file);
+    if(!library.valid()){
+        cerr << "Cannot read " << library_file << endl;
+        return 1;
+    }
+    // All strategies play the same shoes of the bank, picked by the seed,
+    // as many as a round can use.
+    unique_ptr<ShoeBank> bank;
+    const unsigned char * shoes=nullptr;
+    unsigned long long count=rounds+1;
+    if(!bank_file.empty()){
+        bank.reset(new ShoeBank(bank_file));
+        if(!bank->valid())
+            return 1;
+        shoes=bank->shoes(seed,count);
+    }
+    vector<int> entries;
+    if(tag.empty())
+        for(int i=0;i<library.size();++i)
+            entries.push_back(i);
+    else
+        entries=library.with_tag(tag);
+    // Strategies for rules this tool doesn't know are left out.
+    vector<int> known;
+    for(int i : entries){
+        const RulesVariant * rules=find_rules(library.rules(i));
+        if(!rules)
+            cerr << "Strategy " << i << " is for unknown rules " << library.rules(i) << endl;
+        else if(bank&&bank->decks()<rules->decks)
+            cerr << "Strategy " << i << " is for " << rules->decks << " decks, more than the shoes of "
+                 << bank_file << " have" << endl;
+        else
+            known.push_back(i);
+    }
+    entries=known;
+    vector<TournamentResult> results(entries.size());
+    vector<function<void()>> tasks;
+    for(int k=0;k<entries.size();++k){
+        ShoeBank * b=bank.get();
+        tasks.push_back([&library,&entries,&results,k,rounds,seed,b,shoes,count]{
+            results[k]=play_strategy(library.chromosome(entries[k]),
+                                     *find_rules(library.rules(entries[k])),rounds,seed,
+                                     b,shoes,count);
+            results[k].entry=entries[k];
+        });
+    }
+    ThreadPool pool(threads);
+    pool.run(pool.add_client(),tasks);
+    sort(results.begin(),results.end(),
+         [](const TournamentResult & x, const TournamentResult & y){
+             return x.edge>y.edge||(x.edge==y.edge&&x.entry<y.entry);
+         });
+    ofstream os("library_results.csv");
+    os << "rank,entry,hash,rules,fit score,edge,variance,tags" << endl;
+    for(int k=0;k<results.size();++k){
+        const TournamentResult & r=results[k];
+        os << k+1 << "," << r.entry << "," << hex << setw(16) << setfill('0')
+           << library.hash(r.entry) << dec << "," << rules_name(library.rules(r.entry))
+           << "," << r.fitness << "," << r.edge
+           << "," << r.variance << ",\"" << library.tags(r.entry) << "\"" << endl;
+    }
+    cout << "Played " << results.size() << " strategies, results in library_results.csv" << endl;
+    pool.report(cout);
+    return 0;
+}
+
+int main(int argc, char * argv[]){
+    string command=(argc>2) ? argv[1] : "";
+    if(command=="add"&&argc>3)
+        return add(argv[2],argv[3],(argc>4) ? argv[4] : "",(argc>5) ? argv[5] : "0");
+    if(command=="list")
+        return list(argv[2],(argc>3) ? argv[3] : "");
+    if(command=="play"){
+        int rounds=(argc>3) ? atoi(argv[3]) : 10000;
+        int threads=(argc>4) ? atoi(argv[4]) : thread::hardware_concurrency();
+        unsigned seed=(argc>5) ? strtoul(argv[5],nullptr,10) : 1;
+        return play(argv[2],max(1,rounds),threads,seed,(argc>6) ? argv[6] : "",
+                    (argc>7) ? argv[7] : "");
+    }
+    cerr << "Usage: library add <library> <strategy file> [tags] [rules]" << endl;
+    cerr << "       library list <library> [tag]" << endl;
+    cerr << "       library play <library> [rounds] [threads] [seed] [tag] [shoe bank]" << endl;
+    return 1;
+}
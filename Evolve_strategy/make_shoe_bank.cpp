@@ -0,0 +1,58 @@
+// This file writes a shoe bank, the file of shuffled shoes which
+// Evolve and run_simulation.cpp can play instead of shuffling
+// (see 'ShoeBank.h' for the format):
+//
+// make_shoe_bank <bank> <shoes> [decks] [seed]
+//
+// The shoes have one deck each unless 'decks' is given, and are
+// shuffled by the engine seeded by 'seed' (1 by default), so the
+// same arguments always give the same bank. A million shoes of one
+// deck take 52 MB.
+
+#include <iostream>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <cstdio>
+#include <cstring>
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#endif
+
+#include "../Common/StrategyFile.h"
+#include "../Common/ShoeBank.h"
+
+using namespace std;
+
+int main(int argc, char * argv[]){
+    if(argc<3){
+        cerr << "Usage: make_shoe_bank bank shoes [decks] [seed]" << endl;
+        return 1;
+    }
+    string file=argv[1];
+    unsigned long long shoes=strtoull(argv[2],nullptr,10);
+    unsigned decks=(argc>3) ? strtoul(argv[3],nullptr,10) : 1;
+    unsigned long long seed=(argc>4) ? strtoull(argv[4],nullptr,10) : 1;
+    if(shoes==0||decks==0){
+        cerr << "The numbers of shoes and decks must be positive" << endl;
+        return 1;
+    }
+    if(!write_shoe_bank(file,shoes,decks,seed)){
+        cerr << "Cannot write the shoe bank " << file << endl;
+        return 1;
+    }
+    ShoeBank bank(file);
+    if(!bank.valid())
+        return 1;
+    cout << file << ": " << bank.size() << " shoes of " << bank.decks()
+         << " deck(s), seed " << bank.seed() << endl;
+    return 0;
+}
@@ -0,0 +1,126 @@
+'''
+Reader of the population history log written by Evolve (see History.h
+for the format).
+
+History(path) maps the log into memory, so that nothing is loaded until
+it is asked for. len(history) is the number of records, and for record
+k, generation(k), fit_scores(k) and parents(k) are read in place, while
+population(k) decodes the strategies (lists of 800 entries 0/1) starting
+from the last keyframe. generations() goes through all records in order,
+decoding each one against the one before it.
+
+Run as a script it prints the mean and the best fit score of every
+generation in history.bin (or the file given as the first argument).
+'''
+
+from __future__ import print_function
+import mmap
+import struct
+import sys
+
+HISTORY_MAGIC=0x4c484a42
+HISTORY_INDEX_MAGIC=0x58494a42
+HISTORY_VERSION=1
+
+###########################################################################
+
+def unpack_chromosome(packed):
+    # Gene k is the bit k%8 of the byte k/8, same as unpack_chromosome()
+    # in Chromosome.h.
+    return [(packed[k//8]>>(k%8))&1 for k in range(800)]
+
+class History(object):
+    def __init__(self,path):
+        self.file=open(path,'rb')
+        self.data=mmap.mmap(self.file.fileno(),0,access=mmap.ACCESS_READ)
+        magic,version,size,self.keyframe_interval=struct.unpack_from('<IIII',self.data,0)
+        if magic!=HISTORY_MAGIC or version!=HISTORY_VERSION:
+            raise ValueError("not a history log: {}".format(path))
+        # Use the index if it is there, otherwise go through the records.
+        length=len(self.data)
+        self.offsets=[]
+        if length>=32:
+            n,=struct.unpack_from('<Q',self.data,length-16)
+            index_magic,=struct.unpack_from('<I',self.data,length-8)
+            if index_magic==HISTORY_INDEX_MAGIC and 16+8*n+16<=length:
+                self.offsets=list(struct.unpack_from('<{}Q'.format(n),self.data,length-16-8*n))
+                return
+        at=16
+        while at+16<=length:
+            generation,M,keyframe,block=struct.unpack_from('<IIII',self.data,at)
+            if at+16+16*M+block>length:
+                break
+            self.offsets.append(at)
+            at+=16+16*M+block
+
+    def __len__(self):
+        return len(self.offsets)
+
+    def header(self,k):
+        return struct.unpack_from('<IIII',self.data,self.offsets[k])
+
+    def generation(self,k):
+        return self.header(k)[0]
+
+    def fit_scores(self,k):
+        M=self.header(k)[1]
+        return list(struct.unpack_from('<{}d'.format(M),self.data,self.offsets[k]+16))
+
+    def parents(self,k):
+        M=self.header(k)[1]
+        at=self.offsets[k]+16+8*M
+        first=struct.unpack_from('<{}i'.format(M),self.data,at)
+        second=struct.unpack_from('<{}i'.format(M),self.data,at+4*M)
+        return list(zip(first,second))
+
+    def decode(self,k,previous):
+        # Packed strategies of record k, given those of the record before.
+        M=self.header(k)[1]
+        parents=self.parents(k)
+        at=self.offsets[k]+16+16*M
+        packed=[]
+        for i in range(M):
+            flag=self.data[at:at+1]
+            at+=1
+            if flag==b'\x00':
+                packed.append(bytearray(self.data[at:at+100]))
+                at+=100
+                continue
+            n=bytearray(self.data[at:at+1])[0]
+            at+=1
+            g=bytearray(previous[parents[i][0]])
+            pairs=bytearray(self.data[at:at+2*n])
+            for j in range(n):
+                g[pairs[2*j]]^=pairs[2*j+1]
+            at+=2*n
+            packed.append(g)
+        return packed
+
+    def population(self,k):
+        start=k
+        while start>0 and self.header(start)[2]!=1:
+            start-=1
+        packed=[]
+        for j in range(start,k+1):
+            packed=self.decode(j,packed)
+        return [unpack_chromosome(g) for g in packed]
+
+    def generations(self):
+        # Yields (generation, fit scores, parents, population) of each record.
+        packed=[]
+        for k in range(len(self)):
+            packed=self.decode(k,packed)
+            yield (self.generation(k),self.fit_scores(k),self.parents(k),
+                   [unpack_chromosome(g) for g in packed])
+
+###########################################################################
+
+if __name__=='__main__':
+    path='history.bin'
+    if len(sys.argv)>1:
+        path=sys.argv[1]
+    history=History(path)
+    for k in range(len(history)):
+        scores=history.fit_scores(k)
+        print("generation {}: mean fit {}, best fit {}".format(
+            history.generation(k),sum(scores)/len(scores),max(scores)))
@@ -0,0 +1,448 @@
+/**
+
+ Recording of the player's bankroll paths of many games while they are
+ played, in bounded memory, instead of keeping the whole time series of
+ each game (see run_simulation.cpp).
+
+ BankrollPathWriter streams the paths to a binary file (.bjp), downsampled
+ to a fixed stride of rounds: each stride of the path is written as the
+ lowest and the highest bankroll after the rounds of the stride, so the
+ envelope of the path survives the downsampling. Only the current stride
+ and a write buffer are in memory. The file is in the native
+ (little-endian) byte order:
+
+ * 16 byte header (BankrollPathHeader below): uint32 magic 0x50424a42
+   ("BJBP"), uint32 version 1, uint32 rounds per game, uint32 stride,
+ * the games back to back, each as ceil(rounds/stride) pairs of int32
+   (lowest, highest). A game which stops early (the player or the dealer
+   went bankrupt) keeps its last bankroll to the end of the rounds, so
+   every game has the same size and the number of games is the size of
+   the rest of the file over the size of a game.
+
+ In numpy a file is read with
+   h=np.fromfile(f,dtype=np.uint32,count=4)
+   paths=np.fromfile(f,dtype=np.int32,offset=16).reshape(-1,-(-h[2]//h[3]),2)
+
+ BankrollQuantiles keeps a quantile sketch (TDigest) of the bankroll at
+ each of a set of checkpoint rounds over all games, so the fan chart of
+ any number of games costs memory in the number of checkpoints only.
+ BankrollRecorder feeds both from the bankroll after each round.
+
+ TDigest is the merging t-digest of Dunning and Ertl: the values are
+ kept as centroids (a mean and a weight), with the k1 scale function
+ limiting the weight of a centroid so that the centroids are small near
+ the tails, where the quantiles need to be most accurate. At most about
+ the compression number of centroids are kept, however many values are
+ added. Two digests can be merged, so the games can be recorded on
+ separate threads.
+
+ */
+
+using namespace std;
+
+const unsigned BANKROLL_PATH_MAGIC=0x50424a42;
+const unsigned BANKROLL_PATH_VERSION=1;
+
+struct BankrollPathHeader{
+    unsigned magic;
+    unsigned version;
+    unsigned rounds;
+    unsigned stride;
+};
+
+class TDigest{
+public:
+    // Constructor takes the compression, the number of centroids kept is
+    // about this number.
+    TDigest(const double & compression=100);
+    // Add the value with the given weight.
+    void add(const double &, const double & weight=1);
+    // Add all values of the other digest.
+    void merge(const TDigest &);
+    // Value of the given quantile (0 to 1), 0 if there are no values.
+    double quantile(const double &);
+    // Total weight of the values added.
+    double size(){
+        return total+buffered;
+    }
+    // Number of centroids, after merging the added values.
+    int centroids(){
+        compress();
+        return means.size();
+    }
+private:
+    double compression;
+    // Centroids in the order of their means.
+    vector<double> means;
+    vector<double> weights;
+    // Values not merged into the centroids yet.
+    vector<double> buffer_means;
+    vector<double> buffer_weights;
+    double total;
+    double buffered;
+    double lowest;
+    double highest;
+    // Merge the buffer into the centroids.
+    void compress();
+    // The scale function k1 and its inverse.
+    double scale(const double &);
+    double inverse_scale(const double &);
+};
+
+TDigest::TDigest(const double & c){
+    compression=max(10.0,c);
+    total=0;
+    buffered=0;
+    lowest=0;
+    highest=0;
+}
+
+double TDigest::scale(const double & q){
+    return compression/(2*M_PI)*asin(2*q-1);
+}
+
+double TDigest::inverse_scale(const double & k){
+    return (sin(min(k*2*M_PI/compression,M_PI/2))+1)/2;
+}
+
+void TDigest::add(const double & x, const double & w){
+    if(total+buffered==0){
+        lowest=x;
+        highest=x;
+    }
+    lowest=min(lowest,x);
+    highest=max(highest,x);
+    buffer_means.push_back(x);
+    buffer_weights.push_back(w);
+    buffered+=w;
+    // The buffer is merged when it holds several times the centroids.
+    if(buffer_means.size()>=5*compression)
+        compress();
+}
+
+void TDigest::merge(const TDigest & other){
+    if(other.total+other.buffered==0)
+        return;
+    if(total+buffered==0){
+        lowest=other.lowest;
+        highest=other.highest;
+    }
+    lowest=min(lowest,other.lowest);
+    highest=max(highest,other.highest);
+    for(int i=0;i<other.means.size();++i){
+        buffer_means.push_back(other.means[i]);
+        buffer_weights.push_back(other.weights[i]);
+    }
+    for(int i=0;i<other.buffer_means.size();++i){
+        buffer_means.push_back(other.buffer_means[i]);
+        buffer_weights.push_back(other.buffer_weights[i]);
+    }
+    buffered+=other.total+other.buffered;
+    compress();
+}
+
+void TDigest::compress(){
+    if(buffer_means.empty())
+        return;
+    // All centroids and buffered values in the order of their means,
+    // ties in the order they came in, so the digest is deterministic.
+    vector<int> order;
+    vector<double> m=means;
+    vector<double> w=weights;
+    m.insert(m.end(),buffer_means.begin(),buffer_means.end());
+    w.insert(w.end(),buffer_weights.begin(),buffer_weights.end());
+    for(int i=0;i<m.size();++i)
+        order.push_back(i);
+    stable_sort(order.begin(),order.end(),[&m](const int & i, const int & j){
+        return m[i]<m[j];
+    });
+    total+=buffered;
+    buffered=0;
+    buffer_means.clear();
+    buffer_weights.clear();
+    means.clear();
+    weights.clear();
+    // Each centroid takes the next values as long as its weight stays
+    // under the limit of the scale function at its position.
+    double so_far=0;
+    double limit=total*inverse_scale(scale(0)+1);
+    for(int i : order){
+        if(!means.empty()&&so_far+weights.back()+w[i]<=limit){
+            double sum=weights.back()+w[i];
+            means.back()+=(m[i]-means.back())*w[i]/sum;
+            weights.back()=sum;
+            continue;
+        }
+        if(!means.empty()){
+            so_far+=weights.back();
+            limit=total*inverse_scale(scale(so_far/total)+1);
+        }
+        means.push_back(m[i]);
+        weights.push_back(w[i]);
+    }
+}
+
+double TDigest::quantile(const double & q){
+    compress();
+    if(means.empty())
+        return 0;
+    if(means.size()==1)
+        return means[0];
+    double target=min(1.0,max(0.0,q))*total;
+    // Each centroid stands at the middle of its weight, the values
+    // between the middles interpolated linearly, and the values below the
+    // first and above the last towards the lowest and the highest value.
+    double cumulative=0;
+    for(int i=0;i<means.size();++i){
+        double middle=cumulative+weights[i]/2;
+        if(target<middle){
+            if(i==0)
+                return lowest+(means[0]-lowest)*target/middle;
+            double previous=cumulative-weights[i-1]/2;
+            return means[i-1]+(means[i]-means[i-1])*(target-previous)/(middle-previous);
+        }
+        cumulative+=weights[i];
+    }
+    double last=total-weights.back()/2;
+    if(total==last)
+        return highest;
+    return means.back()+(highest-means.back())*(target-last)/(total-last);
+}
+
+class BankrollPathWriter{
+public:
+    // Constructor takes the file, the number of rounds of each game, and
+    // the stride of the downsampling in rounds. If the name is empty the
+    // paths are kept in memory, for a block of games to be appended to the
+    // writer of the file (see append()).
+    BankrollPathWriter(const string &, const int &, const int &);
+    ~BankrollPathWriter();
+    // Start the next game at the given starting bankroll.
+    void start_game(const int &);
+    // Record the player's bankroll after the next round of the game.
+    void record(const int &);
+    // End the game, keeping its last bankroll to the end of its rounds.
+    void end_game();
+    // Append the games kept in memory by the other writer, of the same
+    // rounds and stride, and clear them from it.
+    void append(BankrollPathWriter &);
+    // Number of games written.
+    int games(){
+        return games_written;
+    }
+private:
+    ofstream os;
+    int rounds;
+    int stride;
+    // Rounds recorded in the current game, and the lowest, the highest
+    // and the last bankroll of its current stride.
+    int recorded;
+    int lowest;
+    int highest;
+    int last;
+    int games_written;
+    // Pairs not written to the file yet.
+    vector<int> buffer;
+    void flush();
+};
+
+BankrollPathWriter::BankrollPathWriter(const string & file, const int & r, const int & s){
+    rounds=max(1,r);
+    stride=max(1,min(s,rounds));
+    recorded=0;
+    last=0;
+    games_written=0;
+    if(file.empty())
+        return;
+    os.open(file,ios::binary);
+    BankrollPathHeader h={BANKROLL_PATH_MAGIC,BANKROLL_PATH_VERSION,
+                          (unsigned) rounds,(unsigned) stride};
+    os.write((const char *) &h,sizeof(h));
+    buffer.reserve(1<<16);
+}
+
+BankrollPathWriter::~BankrollPathWriter(){
+    flush();
+}
+
+void BankrollPathWriter::start_game(const int & bankroll){
+    recorded=0;
+    last=bankroll;
+}
+
+void BankrollPathWriter::record(const int & bankroll){
+    if(recorded==rounds)
+        return;
+    if(recorded%stride==0){
+        lowest=bankroll;
+        highest=bankroll;
+    }
+    lowest=min(lowest,bankroll);
+    highest=max(highest,bankroll);
+    last=bankroll;
+    ++recorded;
+    if(recorded%stride==0||recorded==rounds){
+        buffer.push_back(lowest);
+        buffer.push_back(highest);
+        if(os.is_open()&&buffer.size()+2>buffer.capacity())
+            flush();
+    }
+}
+
+void BankrollPathWriter::end_game(){
+    while(recorded<rounds)
+        record(last);
+    recorded=0;
+    ++games_written;
+}
+
+void BankrollPathWriter::append(BankrollPathWriter & other){
+    buffer.insert(buffer.end(),other.buffer.begin(),other.buffer.end());
+    games_written+=other.games_written;
+    other.buffer.clear();
+    other.games_written=0;
+    if(os.is_open()&&buffer.size()>=buffer.capacity())
+        flush();
+}
+
+void BankrollPathWriter::flush(){
+    if(!os.is_open())
+        return;
+    os.write((const char *) buffer.data(),buffer.size()*sizeof(int));
+    buffer.clear();
+}
+
+class BankrollQuantiles{
+public:
+    // Constructor takes the checkpoint rounds, in increasing order, and
+    // the compression of their digests.
+    BankrollQuantiles(const vector<int> &, const double & compression=100);
+    // Record the player's bankroll after the given round of a game.
+    void record(const int &, const int &);
+    // End the game, keeping its last bankroll at the checkpoints after
+    // its last round.
+    void end_game();
+    // Add the games of the other quantiles, of the same checkpoints.
+    void merge(const BankrollQuantiles &);
+    // Write the given quantiles of the bankroll at each checkpoint to the
+    // CSV file, one line per checkpoint: the round, then the quantiles,
+    // after a header line with the quantiles.
+    void write(const string &, const vector<double> &);
+    vector<int> get_checkpoints(){
+        return checkpoints;
+    }
+    TDigest & digest(const int & k){
+        return digests[k];
+    }
+private:
+    vector<int> checkpoints;
+    vector<TDigest> digests;
+    // Next checkpoint of the current game, and its last bankroll.
+    int next;
+    int last;
+};
+
+BankrollQuantiles::BankrollQuantiles(const vector<int> & c, const double & compression){
+    checkpoints=c;
+    digests=vector<TDigest>(checkpoints.size(),TDigest(compression));
+    next=0;
+    last=0;
+}
+
+void BankrollQuantiles::record(const int & round, const int & bankroll){
+    last=bankroll;
+    while(next<checkpoints.size()&&checkpoints[next]<=round){
+        digests[next].add(bankroll);
+        ++next;
+    }
+}
+
+void BankrollQuantiles::end_game(){
+    for(;next<checkpoints.size();++next)
+        digests[next].add(last);
+    next=0;
+}
+
+void BankrollQuantiles::merge(const BankrollQuantiles & other){
+    for(int k=0;k<digests.size()&&k<other.digests.size();++k)
+        digests[k].merge(other.digests[k]);
+}
+
+void BankrollQuantiles::write(const string & file, const vector<double> & quantiles){
+    ofstream os(file);
+    os << "round";
+    for(double q : quantiles)
+        os << "," << q;
+    os << endl;
+    for(int k=0;k<checkpoints.size();++k){
+        os << checkpoints[k];
+        for(double q : quantiles)
+            os << "," << digests[k].quantile(q);
+        os << endl;
+    }
+}
+
+// Records the paths and the quantiles of the games from the bankroll
+// after each of their rounds.
+class BankrollRecorder{
+public:
+    // Constructor takes the file of the paths (none if empty), the rounds
+    // of a game, the stride of the paths, and the number of checkpoints,
+    // spread evenly over the rounds of a game.
+    BankrollRecorder(const string &, const int &, const int &, const int &);
+    // Start the next game, at the given starting bankroll (round 0).
+    void start_game(const int &);
+    // Record the player's bankroll after the given round.
+    void record(const int &, const int &);
+    // End the game.
+    void end_game();
+    // Append the games of the other recorder, of a block of games kept in
+    // memory, and clear them from it.
+    void append(BankrollRecorder &);
+    BankrollPathWriter & get_paths(){
+        return paths;
+    }
+    BankrollQuantiles & get_quantiles(){
+        return quantiles;
+    }
+private:
+    BankrollPathWriter paths;
+    BankrollQuantiles quantiles;
+    // Checkpoints spread evenly over the rounds, starting at round 0.
+    static vector<int> spread(const int &, const int &);
+};
+
+BankrollRecorder::BankrollRecorder(const string & file, const int & rounds,
+                                   const int & stride, const int & checkpoints) :
+    paths(file,rounds,stride), quantiles(spread(rounds,checkpoints)){
+}
+
+vector<int> BankrollRecorder::spread(const int & rounds, const int & checkpoints){
+    vector<int> c;
+    int n=max(1,checkpoints);
+    for(int k=0;k<=n;++k)
+        c.push_back((long long) rounds*k/n);
+    c.erase(unique(c.begin(),c.end()),c.end());
+    return c;
+}
+
+void BankrollRecorder::start_game(const int & bankroll){
+    paths.start_game(bankroll);
+    quantiles.record(0,bankroll);
+}
+
+void BankrollRecorder::record(const int & round, const int & bankroll){
+    paths.record(bankroll);
+    quantiles.record(round,bankroll);
+}
+
+void BankrollRecorder::end_game(){
+    paths.end_game();
+    quantiles.end_game();
+}
+
+void BankrollRecorder::append(BankrollRecorder & block){
+    paths.append(block.paths);
+    quantiles.merge(block.quantiles);
+    block.quantiles=BankrollQuantiles(block.quantiles.get_checkpoints());
+}
@@ -1,11 +1,15 @@
 /**
  * BasicStrategy is a repository of methods for playing the basic strategy.
+ * It is the strategy the game of Engine.h asks for its decisions.
  */
 
 using namespace std;
 
-// Input is to be a string with filename and .csv appended to it.
+// Input is to be a string with filename and .csv appended to it, or
+// with .bjs appended to it for the binary strategy (see StrategyFile.h).
 vector<int> read_strategy(const string & file){
+    if(is_strategy_file(file))
+        return load_strategy(file);
     string from(file);
     ifstream is(from);
     string str;
@@ -27,7 +31,11 @@ vector<int> read_strategy(const string & file){
 
 class BasicStrategy{
 public:
-    BasicStrategy() {
+    // Reads the strategy from strategy_chromosome.csv.
+    // Can also be the binary strategy strategy_chromosome.bjs.
+    BasicStrategy() : BasicStrategy(read_strategy("strategy_chromosome.csv")) {};
+    // The strategy of the given chromosome vector.
+    BasicStrategy(const vector<int> & chrom) {
         for(int i=0;i<10;++i){
             vector<int> row(10,0);
             table_split.push_back(row);
@@ -48,10 +56,6 @@ public:
             vector<int> row(10,0);
             table_hard_stand.push_back(row);
         }
-        //**
-        string chrom_file="strategy_chromosome.csv";
-        vector<int> chrom=read_strategy(chrom_file);
-        //**
         vector<int> split_flattened;
         vector<int> soft_double_down_flattened;
         vector<int> hard_double_down_flattened;
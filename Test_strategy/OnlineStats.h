@@ -0,0 +1,131 @@
+/**
+
+ Statistics of a stream of values kept in constant memory, so that any
+ number of games can be summarized without keeping their results (see
+ calculate_edge_and_bankroll() in run_simulation.cpp).
+
+ RunningStats keeps the count, the mean and the sum of the squared
+ deviations from the mean with Welford's update, which stays accurate
+ where the sum of the squares would lose the variance to rounding.
+ Histogram counts the values in equal bins of a fixed range, with the
+ values below and above the range counted apart. Both can be merged, the
+ RunningStats with the pairwise update of Chan et al.; merged in a fixed
+ order they give the same result however the values were split between
+ the threads.
+
+ Values which are not numbers (such as the share of the double downs won
+ in a game without double downs) are counted apart and left out.
+
+ */
+
+using namespace std;
+
+class RunningStats{
+public:
+    RunningStats(){
+        count=0;
+        mean=0;
+        squares=0;
+        missing=0;
+    }
+    // Add the value.
+    void add(const double & x){
+        if(x!=x){
+            ++missing;
+            return;
+        }
+        ++count;
+        double delta=x-mean;
+        mean+=delta/count;
+        squares+=delta*(x-mean);
+    }
+    // Add the values of the other statistics.
+    void merge(const RunningStats & other){
+        missing+=other.missing;
+        if(other.count==0)
+            return;
+        long long n=count+other.count;
+        double delta=other.mean-mean;
+        mean+=delta*other.count/n;
+        squares+=other.squares+delta*delta*count*other.count/n;
+        count=n;
+    }
+    long long get_count(){
+        return count;
+    }
+    long long get_missing(){
+        return missing;
+    }
+    double get_mean(){
+        return mean;
+    }
+    // Sample variance, 0 for less than two values.
+    double get_variance(){
+        return (count>1) ? squares/(count-1) : 0;
+    }
+    // Standard error of the mean.
+    double get_standard_error(){
+        return (count>0) ? sqrt(get_variance()/count) : 0;
+    }
+private:
+    long long count;
+    double mean;
+    double squares;
+    long long missing;
+};
+
+class Histogram{
+public:
+    // Constructor takes the range and the number of bins.
+    Histogram(const double & l=0, const double & h=1, const int & b=50){
+        lowest=l;
+        highest=h;
+        counts=vector<long long>(max(1,b),0);
+        below=0;
+        above=0;
+    }
+    // Count the value, values out of the range are counted below or
+    // above it.
+    void add(const double & x){
+        if(x!=x)
+            return;
+        if(x<lowest){
+            ++below;
+            return;
+        }
+        if(x>=highest){
+            ++above;
+            return;
+        }
+        int k=(x-lowest)/(highest-lowest)*counts.size();
+        counts[min(k,(int) counts.size()-1)]++;
+    }
+    // Add the counts of the other histogram, of the same bins.
+    void merge(const Histogram & other){
+        for(int k=0;k<counts.size()&&k<other.counts.size();++k)
+            counts[k]+=other.counts[k];
+        below+=other.below;
+        above+=other.above;
+    }
+    double get_lowest(){
+        return lowest;
+    }
+    double get_highest(){
+        return highest;
+    }
+    vector<long long> get_counts(){
+        return counts;
+    }
+    long long get_below(){
+        return below;
+    }
+    long long get_above(){
+        return above;
+    }
+private:
+    double lowest;
+    double highest;
+    vector<long long> counts;
+    long long below;
+    long long above;
+};
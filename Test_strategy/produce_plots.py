@@ -240,4 +240,23 @@ fig.savefig("split_loss_probability.pdf",\
                    transparent=False, bbox_inches=None, pad_inches=0.1,\
                    frameon=None)
 
+# Fan chart of the bankroll of all games, from the quantiles of the
+# bankroll at the checkpoint rounds (see BankrollPath.h).
+quantiles=np.loadtxt('bankroll_quantiles.csv',delimiter=',',skiprows=1)
+rounds=quantiles[:,0]
+fig=plt.figure(figsize=(8,5))
+plt.fill_between(rounds,quantiles[:,1],quantiles[:,5],alpha=0.3,label="5% to 95%")
+plt.fill_between(rounds,quantiles[:,2],quantiles[:,4],alpha=0.5,label="25% to 75%")
+plt.plot(rounds,quantiles[:,3],label="median")
+plt.xlabel("rounds")
+plt.ylabel("player's bankroll")
+plt.legend()
+plt.title("Player's bankroll over all games in considered basic strategy")
+plt.show()
+fig.savefig("bankroll_fan_chart.pdf",\
+                   dpi=300, facecolor='w', edgecolor='w',\
+                   orientation='portrait', papertype=None, format=None,\
+                   transparent=False, bbox_inches=None, pad_inches=0.1,\
+                   frameon=None)
+
 print ct2,ctmin2,ct4,ctmin4,ct3
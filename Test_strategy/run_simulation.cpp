@@ -8,24 +8,97 @@
 #include <array>
 #include <random>       
 #include <chrono> 
+#include <climits>
+#include <thread>
+#include <sstream>
+#include <cstring>
+#include <memory>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#endif
 
-#include "Deck.h"
+#include "../Common/Deck.h"
+#include "../Common/StrategyFile.h"
+#include "../Common/ShoeBank.h"
+#include "../Common/HandState.h"
+#include "../Common/SharedDeal.h"
 #include "BasicStrategy.h"
+#include "../Common/Rules.h"
+#include "../Common/Engine.h"
 #include "Game.h"
+#include "BankrollPath.h"
+#include "OnlineStats.h"
 
 using namespace std;
 
-void play_game(Game game1){
-    // Run 10000 rounds of game. Here 30 and 51 are redundant argruments,
-    // the Game actually doesn't have any role for those parameters any more.
-    // The former meaning was that the dealer would spontaneously reshuffle the
-    // deck once the deck pointer was between 30 and 51, that is, when between
-    // 30 and 51 cards have been dealt.
-    game1.play(10000,30,51);
-    
-    double total_number_of_wins=game1.get_player_won();
-    double total_number_of_draws=game1.get_draws();
-    double total_rounds_played=game1.get_rounds_played();
+// Statistics of a game, as printed for the sample game. The statistics of
+// the segments of a game add up to the statistics of the whole game.
+struct GameStats{
+    int player_bankroll;
+    int dealer_bankroll;
+    int player_won;
+    int draws;
+    int rounds_played;
+    int times_player_doubled_down;
+    int times_player_doubled_down_and_won;
+    int times_player_doubled_down_and_lost;
+    int times_player_split;
+    int times_player_split_and_won;
+    int times_player_split_and_lost;
+    vector<int> player_time_series;
+    // Times each gene of the strategy was looked up.
+    vector<long long> cell_visits;
+};
+
+GameStats game_stats(Game & game){
+    GameStats stats;
+    stats.player_bankroll=game.get_player_bankroll();
+    stats.dealer_bankroll=game.get_dealer_bankroll();
+    stats.player_won=game.get_player_won();
+    stats.draws=game.get_draws();
+    stats.rounds_played=game.get_rounds_played();
+    stats.times_player_doubled_down=game.get_times_player_doubled_down();
+    stats.times_player_doubled_down_and_won=game.get_times_player_doubled_down_and_won();
+    stats.times_player_doubled_down_and_lost=game.get_times_player_doubled_down_and_lost();
+    stats.times_player_split=game.get_times_player_split();
+    stats.times_player_split_and_won=game.get_times_player_split_and_won();
+    stats.times_player_split_and_lost=game.get_times_player_split_and_lost();
+    stats.player_time_series=game.get_player_time_series();
+    stats.cell_visits=game.get_cell_visits();
+    return stats;
+}
+
+// Add the statistics of the next segment, whose player's bankroll
+// time series is shifted by the given offset.
+void add_segment(GameStats & stats, const GameStats & segment, const int & offset){
+    stats.player_won+=segment.player_won;
+    stats.draws+=segment.draws;
+    stats.rounds_played+=segment.rounds_played;
+    stats.times_player_doubled_down+=segment.times_player_doubled_down;
+    stats.times_player_doubled_down_and_won+=segment.times_player_doubled_down_and_won;
+    stats.times_player_doubled_down_and_lost+=segment.times_player_doubled_down_and_lost;
+    stats.times_player_split+=segment.times_player_split;
+    stats.times_player_split_and_won+=segment.times_player_split_and_won;
+    stats.times_player_split_and_lost+=segment.times_player_split_and_lost;
+    for(int x : segment.player_time_series)
+        stats.player_time_series.push_back(x+offset);
+    stats.cell_visits.resize(segment.cell_visits.size(),0);
+    for(int k=0;k<segment.cell_visits.size();++k)
+        stats.cell_visits[k]+=segment.cell_visits[k];
+}
+
+void print_game(const GameStats & game1){
+    double total_number_of_wins=game1.player_won;
+    double total_number_of_draws=game1.draws;
+    double total_rounds_played=game1.rounds_played;
     double total_rounds_losses=total_rounds_played-total_number_of_wins-total_number_of_draws;
     double prob_win=total_number_of_wins/total_rounds_played;
     double prob_loss=total_rounds_losses/total_rounds_played;
@@ -37,7 +110,7 @@ void play_game(Game game1){
     cout << "Player's edge is " << prob_win-prob_loss << endl;
     
     string filename="player_time_series.csv";
-    vector<int> player_time_series_1=game1.get_player_time_series();
+    vector<int> player_time_series_1=game1.player_time_series;
     ofstream myfile(filename);
     int vsize = player_time_series_1.size()-1;
     for(int n=0; n<vsize; n++){
@@ -46,168 +119,709 @@ void play_game(Game game1){
     }
     myfile << player_time_series_1[vsize-1];
     
-    cout << "Player's bankroll is " << game1.get_player_bankroll() << endl;
-    cout << "Dealer's bankroll is " << game1.get_dealer_bankroll() << endl;
-    cout << "Player has won " << game1.get_player_won() << " games" << endl;
-    cout << "Total number of rounds played is "<< game1.get_rounds_played() << endl;
-    cout << "Total number of draws played is " << game1.get_draws() << endl;
-    cout << "Total number of draws and wins is " << game1.get_draws()+
-                                                    game1.get_player_won() << endl;
-    cout << "Total number of times player doubled down " << game1.get_times_player_doubled_down() << endl;
-    cout << "Total number of times player doubled down and won " << game1.get_times_player_doubled_down_and_won() << endl;
-    cout << "Total number of times player doubled down and lost " << game1.get_times_player_doubled_down_and_lost() << endl;
-    cout << "Total number of times player split " << game1.get_times_player_split() << endl;
-    cout << "Total number of times player split and won " << game1.get_times_player_split_and_won() << endl;
-    cout << "Total number of times player split and lost " << game1.get_times_player_split_and_lost() << endl;
+    // Times each gene was looked up, in the order of the genes of
+    // strategy_chromosome.csv.
+    filename="cell_visits.csv";
+    ofstream myfilev(filename);
+    vsize = game1.cell_visits.size()-1;
+    for(int n=0; n<vsize; n++){
+        myfilev << game1.cell_visits[n];
+        myfilev << "," ;
+    }
+    myfilev << game1.cell_visits[vsize];
+    
+    cout << "Player's bankroll is " << game1.player_bankroll << endl;
+    cout << "Dealer's bankroll is " << game1.dealer_bankroll << endl;
+    cout << "Player has won " << game1.player_won << " games" << endl;
+    cout << "Total number of rounds played is "<< game1.rounds_played << endl;
+    cout << "Total number of draws played is " << game1.draws << endl;
+    cout << "Total number of draws and wins is " << game1.draws+
+                                                    game1.player_won << endl;
+    cout << "Total number of times player doubled down " << game1.times_player_doubled_down << endl;
+    cout << "Total number of times player doubled down and won " << game1.times_player_doubled_down_and_won << endl;
+    cout << "Total number of times player doubled down and lost " << game1.times_player_doubled_down_and_lost << endl;
+    cout << "Total number of times player split " << game1.times_player_split << endl;
+    cout << "Total number of times player split and won " << game1.times_player_split_and_won << endl;
+    cout << "Total number of times player split and lost " << game1.times_player_split_and_lost << endl;
     cout << "Remember that the split hands are played twice, so the sum of number of drawn split hands, won split hands, and lost split hands is twice the number of split hands" << endl;
-    cout << "Size of player time series is " << game1.get_player_time_series().size() << " which should be larger than the number of rounds played by the number of hands split." <<endl;
+    cout << "Size of player time series is " << game1.player_time_series.size() << " which should be larger than the number of rounds played by the number of hands split." <<endl;
 }
 
-void calculate_edge_and_bankroll(const int & rounds){
-    vector<double> edges={};
-    vector<double> tot_wins={};
-    vector<double> tot_losses={};
-    vector<int> player_bankrolls={};
-    vector<double> prob_double_down={};
-    vector<double> prob_double_down_won={};
-    vector<double> prob_double_down_loss={};
-    vector<double> prob_split={};
-    vector<double> prob_split_won={};
-    vector<double> prob_split_loss={};
-    for(int round=0;round<rounds;++round){
-        Game game1(1000,2000,2);
-        game1.play(10000,30,51);
-
-        double total_number_of_wins=game1.get_player_won();
-        double total_rounds_played=game1.get_rounds_played();
-        double total_number_of_draws=game1.get_draws();
-        double total_rounds_losses=total_rounds_played-total_number_of_wins-total_number_of_draws;
-        double prob_win=total_number_of_wins/total_rounds_played;
-        double prob_loss=total_rounds_losses/total_rounds_played;
-        double edge=prob_win-prob_loss;
-        edges.push_back(edge);
-
-        player_bankrolls.push_back(game1.get_player_bankroll());
-
-        double tot_double_downs=game1.get_times_player_doubled_down();
-        double double_downs_won=game1.get_times_player_doubled_down_and_won();
-        double double_downs_lost=game1.get_times_player_doubled_down_and_lost();
-        prob_double_down.push_back(tot_double_downs/total_rounds_played);
-        prob_double_down_won.push_back(double_downs_won/tot_double_downs);
-        prob_double_down_loss.push_back(double_downs_lost/tot_double_downs);
-
-        double tot_splits=game1.get_times_player_split();
-        double split_won=game1.get_times_player_split_and_won();
-        double split_lost=game1.get_times_player_split_and_lost();
-        prob_split.push_back(tot_splits/total_rounds_played);
-        prob_split_won.push_back(split_won/(2*tot_splits));
-        prob_split_loss.push_back(split_lost/(2*tot_splits));
-        
-        tot_wins.push_back(total_number_of_wins/total_rounds_played);
-        tot_losses.push_back(total_rounds_losses/total_rounds_played);
-    }
-
-    string filename="edges.csv";
-    ofstream myfile1(filename);
-    int vsize = edges.size()-1;
-    for(int n=0; n<vsize; n++){
-        myfile1 << edges[n];
-        myfile1 << "," ;
+void play_game(Game game1){
+    // Run 10000 rounds of game. Here 30 and 51 are redundant argruments,
+    // the Game actually doesn't have any role for those parameters any more.
+    // The former meaning was that the dealer would spontaneously reshuffle the
+    // deck once the deck pointer was between 30 and 51, that is, when between
+    // 30 and 51 cards have been dealt.
+    game1.play(10000,30,51);
+    print_game(game_stats(game1));
+}
+
+// Seed of segment 'k' of the game with the given seed.
+unsigned segment_seed(const unsigned & seed, const int & k){
+    unsigned s;
+    seed_seq seq{seed,(unsigned) k};
+    seq.generate(&s,&s+1);
+    return s;
+}
+
+// Same as play_game(), with the rounds split into the given number of
+// segments played on separate threads. Each segment starts from a freshly
+// shuffled deck of its own seed, which is fine since the Game reshuffles
+// after a third of the deck anyway. The segments are played with
+// bankrolls large enough to never go bankrupt. Then they are added up in
+// order: if the player's bankroll at the start of a segment plus the
+// lowest point of the segment's time series (or the dealer's one minus
+// the highest point) would reach zero, the segment is replayed from its
+// seed with the actual bankrolls, stopping where the Game would stop.
+void play_segmented_game(const int & p, const int & d, const int & b,
+                         const int & rounds, const int & segments){
+    unsigned seed=rand();
+    // A round can't cost more than the most bets of the rules of the Game.
+    int start=Game::get_max_bets()*b*rounds+1;
+    vector<GameStats> stats(segments);
+    vector<thread> threads;
+    for(int k=0;k<segments;++k){
+        int segment_rounds=rounds/segments+(k<rounds%segments ? 1 : 0);
+        threads.push_back(thread([&stats,seed,k,segment_rounds,start,b]{
+            Game game(start,start,b);
+            game.seed(segment_seed(seed,k));
+            game.play(segment_rounds,30,51);
+            stats[k]=game_stats(game);
+        }));
     }
-    myfile1 << edges[vsize-1];
-    
-    filename="tot_wins.csv";
-    ofstream myfilew(filename);
-    vsize = tot_wins.size()-1;
-    for(int n=0; n<vsize; n++){
-        myfilew << tot_wins[n];
-        myfilew << "," ;
+    for(thread & t : threads)
+        t.join();
+    GameStats total={p,d,0,0,0,0,0,0,0,0,0,{}};
+    for(int k=0;k<segments;++k){
+        int segment_rounds=rounds/segments+(k<rounds%segments ? 1 : 0);
+        const vector<int> & series=stats[k].player_time_series;
+        int lowest=0;
+        int highest=0;
+        for(int x : series){
+            lowest=min(lowest,x-start);
+            highest=max(highest,x-start);
+        }
+        if(total.player_bankroll+lowest<=0||total.dealer_bankroll-highest<=0){
+            Game game(total.player_bankroll,total.dealer_bankroll,b);
+            game.seed(segment_seed(seed,k));
+            game.play(segment_rounds,30,51);
+            add_segment(total,game_stats(game),0);
+            total.player_bankroll=game.get_player_bankroll();
+            total.dealer_bankroll=game.get_dealer_bankroll();
+            if(game.get_rounds_played()<segment_rounds)
+                break;
+            continue;
+        }
+        int net=stats[k].player_bankroll-start;
+        add_segment(total,stats[k],total.player_bankroll-start);
+        total.player_bankroll+=net;
+        total.dealer_bankroll-=net;
     }
-    myfilew << tot_wins[vsize-1];
-    
-    filename="tot_losses.csv";
-    ofstream myfilel(filename);
-    vsize = tot_losses.size()-1;
-    for(int n=0; n<vsize; n++){
-        myfilel << tot_losses[n];
-        myfilel << "," ;
+    print_game(total);
+}
+
+// Situations of the initial deal, in which the strategies are compared:
+// a pair of each rank, a soft count or a hard count of the two cards,
+// against each dealer's upcard.
+const int SITUATIONS=3*20*10;
+
+// Name of the situation, such as "hard 16 vs T".
+string situation_name(const int & s){
+    const string ranks="A23456789T";
+    int kind=s/200;
+    int row=(s/10)%20;
+    string name=(kind==0) ? "pair "+ranks.substr(row,1) :
+        string(kind==1 ? "soft " : "hard ")+to_string(row+2);
+    return name+" vs "+ranks.substr(s%10,1);
+}
+
+// Situation of the initial deal of the given ranks of the player's two
+// cards and the dealer's upcard (see HandState.h), -1 for the natural.
+int initial_situation(const int & first, const int & second, const int & up){
+    int state=hand_next[hand_next[HAND_EMPTY][first]][second];
+    if(state==HAND_NATURAL)
+        return -1;
+    if(first==second)
+        return 10*first+up;
+    return (hand_soft[state] ? 200 : 400)+10*(hand_total[state]-2)+up;
+}
+
+// First decision of the strategy of the given genes on the initial deal,
+// in the order of Game.h: 'P' split, 'D' double down, 'S' stand, 'H' hit.
+char initial_action(const vector<int> & chrom, const int & first, const int & second,
+                    const int & up){
+    if(first==second&&chrom[10*first+up]==1)
+        return 'P';
+    int state=hand_next[hand_next[HAND_EMPTY][first]][second];
+    int row=hand_total[state]-2;
+    if(hand_soft[state]){
+        int other=(first==HAND_ACE) ? second : first;
+        if(other!=HAND_TEN&&chrom[100+10*other+up]==1)
+            return 'D';
+        return chrom[400+10*row+up]==1 ? 'S' : 'H';
     }
-    myfilel << tot_losses[vsize-1];
+    if(chrom[200+10*row+up]==1)
+        return 'D';
+    return chrom[600+10*row+up]==1 ? 'S' : 'H';
+}
 
-    filename="player_bankrolls.csv";
-    ofstream myfile2(filename);
-    vsize = player_bankrolls.size()-1;
-    for(int n=0; n<vsize; n++){
-        myfile2 << player_bankrolls[n];
-        myfile2 << "," ;
+// Results of a chunk of the head to head rounds.
+struct HeadToHead{
+    // Net result of each round in bets, of each strategy and of each
+    // strategy minus the first one.
+    vector<RunningStats> results;
+    vector<RunningStats> differences;
+    // Rounds of each situation, and the rounds in which each strategy's
+    // first decision differs from the first strategy's.
+    vector<long long> rounds;
+    vector<vector<long long>> disagreements;
+    HeadToHead(const int & n){
+        results=vector<RunningStats>(n);
+        differences=vector<RunningStats>(n);
+        rounds=vector<long long>(SITUATIONS,0);
+        disagreements=vector<vector<long long>>(n,vector<long long>(SITUATIONS,0));
+    }
+    void merge(const HeadToHead & other){
+        for(int k=0;k<results.size();++k){
+            results[k].merge(other.results[k]);
+            differences[k].merge(other.differences[k]);
+            for(int s=0;s<SITUATIONS;++s)
+                disagreements[k][s]+=other.disagreements[k][s];
+        }
+        for(int s=0;s<SITUATIONS;++s)
+            rounds[s]+=other.rounds[s];
     }
-    myfile2 << player_bankrolls[vsize-1];
+};
 
-    filename="prob_double_down.csv";
-    ofstream myfile3(filename);
-    vsize = prob_double_down.size()-1;
-    for(int n=0; n<vsize; n++){
-        myfile3 << prob_double_down[n];
-        myfile3 << "," ;
+// Play the strategies of the given files head to head for the given number
+// of rounds on the shared deal (see SharedDeal.h), so that all of them
+// play exactly the same rounds, each round on a full deck, or on the
+// shoes of the shoe bank if there is one. The bankrolls are large enough
+// for none of them to go bankrupt. The rounds are played in chunks of
+// 100000 rounds on the given number of threads, the deck of chunk 'k'
+// seeded by the seed of segment 'k' of the given seed, and the chunks are
+// added up in their order.
+// Each strategy is compared with the first one on the same rounds: the
+// difference of their mean net results, with its standard error, is
+// printed to console along with how many more rounds two independent runs
+// would need for the same standard error. The situations of the initial
+// deal in which the strategies decide differently from the first one are
+// written to head_to_head_disagreements.csv, one line per situation:
+// the situation, the rounds in which it was dealt, then for each strategy
+// the rounds in which its first decision differed from the first
+// strategy's, the most frequent first.
+void play_head_to_head(const vector<string> & files, const long long & rounds,
+                       ShoeBank * bank=nullptr, int threads=thread::hardware_concurrency(),
+                       unsigned seed=rand()){
+    const int chunk_rounds=100000;
+    const int start=1000000000;
+    int n=files.size();
+    threads=max(1,threads);
+    vector<vector<int>> chroms;
+    for(const string & file : files)
+        chroms.push_back(read_strategy(file));
+    // Each round plays its own shoe of the bank, none of them twice.
+    if(bank!=nullptr&&(unsigned long long) rounds>bank->size()){
+        cerr << rounds << " rounds need as many shoes, the shoe bank has only "
+             << bank->size() << endl;
+        return;
+    }
+    int chunks=(rounds+chunk_rounds-1)/chunk_rounds;
+    vector<unique_ptr<HeadToHead>> done(chunks);
+    atomic<int> next(0);
+    vector<thread> pool;
+    for(int t=0;t<threads;++t){
+        pool.push_back(thread([&]{
+            for(int c=next++;c<chunks;c=next++){
+                unique_ptr<HeadToHead> chunk(new HeadToHead(n));
+                int chunk_size=min((long long) chunk_rounds,rounds-(long long) c*chunk_rounds);
+                vector<SharedPlayer> players;
+                for(const vector<int> & chrom : chroms)
+                    players.push_back(SharedPlayer(chrom,start,start,2));
+                unsigned long long count=chunk_size;
+                SharedDeal deal=(bank!=nullptr) ?
+                    SharedDeal(bank->shoes((unsigned long long) c*chunk_rounds,count),
+                               bank->cards(),count) :
+                    SharedDeal(segment_seed(seed,c));
+                vector<int> before(n);
+                for(int round=0;round<chunk_size;++round){
+                    deal.next();
+                    for(int k=0;k<n;++k){
+                        before[k]=players[k].get_player_bankroll();
+                        players[k].play_round(deal);
+                    }
+                    double first=(players[0].get_player_bankroll()-before[0])/2.0;
+                    for(int k=0;k<n;++k){
+                        double x=(players[k].get_player_bankroll()-before[k])/2.0;
+                        chunk->results[k].add(x);
+                        chunk->differences[k].add(x-first);
+                    }
+                    int s=initial_situation(deal.rank(0),deal.rank(2),deal.rank(1));
+                    if(s<0)
+                        continue;
+                    chunk->rounds[s]++;
+                    char action=initial_action(chroms[0],deal.rank(0),deal.rank(2),deal.rank(1));
+                    for(int k=1;k<n;++k)
+                        if(initial_action(chroms[k],deal.rank(0),deal.rank(2),deal.rank(1))!=action)
+                            chunk->disagreements[k][s]++;
+                }
+                done[c]=move(chunk);
+            }
+        }));
+    }
+    for(thread & t : pool)
+        t.join();
+    HeadToHead total(n);
+    for(int c=0;c<chunks;++c)
+        total.merge(*done[c]);
+    
+    for(int k=0;k<n;++k){
+        RunningStats & x=total.results[k];
+        cout << "Strategy " << files[k] << ": mean net result " << x.get_mean()
+             << " bets per round, standard error " << x.get_standard_error() << endl;
     }
-    myfile3 << prob_double_down[vsize-1];
+    for(int k=1;k<n;++k){
+        RunningStats & d=total.differences[k];
+        // Two independent runs of the same rounds add up the variances.
+        double independent=total.results[0].get_variance()+total.results[k].get_variance();
+        cout << files[k] << " minus " << files[0] << ": " << d.get_mean()
+             << " bets per round, standard error " << d.get_standard_error()
+             << " (independent runs would need " << independent/max(1e-12,d.get_variance())
+             << " times the rounds for the same)" << endl;
+    }
+    vector<int> situations;
+    for(int s=0;s<SITUATIONS;++s){
+        long long most=0;
+        for(int k=1;k<n;++k)
+            most=max(most,total.disagreements[k][s]);
+        if(most>0)
+            situations.push_back(s);
+    }
+    auto most=[&total,n](const int & s){
+        long long m=0;
+        for(int k=1;k<n;++k)
+            m=max(m,total.disagreements[k][s]);
+        return m;
+    };
+    stable_sort(situations.begin(),situations.end(),[&most](const int & s, const int & t){
+        return most(s)>most(t);
+    });
+    ofstream os("head_to_head_disagreements.csv");
+    os << "situation,rounds";
+    for(int k=1;k<n;++k)
+        os << "," << files[k];
+    os << endl;
+    for(int s : situations){
+        os << situation_name(s) << "," << total.rounds[s];
+        for(int k=1;k<n;++k)
+            os << "," << total.disagreements[k][s];
+        os << endl;
+    }
+    cout << situations.size() << " situations of the initial deal with different decisions,"
+         << " in head_to_head_disagreements.csv" << endl;
+}
 
-    filename="prob_double_down_won.csv";
-    ofstream myfile4(filename);
-    vsize = prob_double_down_won.size()-1;
-    for(int n=0; n<vsize; n++){
-        myfile4 << prob_double_down_won[n];
-        myfile4 << "," ;
+// Mean net result per round, in bets, of the given chunk of rounds of the
+// strategy of the first of the given genes, or with two of them the first
+// one's minus the second one's. One strategy plays the Game, from the deck
+// seeded by the seed of segment 'chunk' of the given seed, or from its own
+// range of the shoes of the shoe bank; two strategies play the same
+// rounds on the shared deal, as in play_head_to_head(). The bankrolls are
+// large enough for nobody to go bankrupt.
+double play_chunk(const vector<vector<int>> & chroms, const int & rounds, const int & chunk,
+                  const unsigned & seed, ShoeBank * bank){
+    const int start=1000000000;
+    unsigned long long count=rounds;
+    const unsigned char * shoes=(bank!=nullptr) ?
+        bank->shoes((unsigned long long) chunk*rounds,count) : nullptr;
+    if(chroms.size()==1){
+        CountingGame game(start,start,2,chroms[0]);
+        if(shoes!=nullptr)
+            game.use_bank(shoes,bank->cards(),count);
+        else
+            game.seed(segment_seed(seed,chunk));
+        game.play(rounds,30,51);
+        return (game.get_player_bankroll()-start)/2.0/rounds;
     }
-    myfile4 << prob_double_down_won[vsize-1];
+    vector<SharedPlayer> players;
+    for(int k=0;k<2;++k)
+        players.push_back(SharedPlayer(chroms[k],start,start,2));
+    SharedDeal deal=(shoes!=nullptr) ? SharedDeal(shoes,bank->cards(),count) :
+        SharedDeal(segment_seed(seed,chunk));
+    for(int round=0;round<rounds;++round){
+        deal.next();
+        for(SharedPlayer & player : players)
+            player.play_round(deal);
+    }
+    return (players[0].get_player_bankroll()-players[1].get_player_bankroll())/2.0/rounds;
+}
 
-    filename="prob_double_down_loss.csv";
-    ofstream myfile5(filename);
-    vsize = prob_double_down_loss.size()-1;
-    for(int n=0; n<vsize; n++){
-        myfile5 << prob_double_down_loss[n];
-        myfile5 << "," ;
+// Simulate the edge of the strategy of the first file, or with two files
+// the difference of the mean net results of the two strategies on the
+// same rounds, until its standard error is at most the given target (or
+// the given most rounds have been played). The rounds are played in
+// chunks of the given number of rounds, spread over the given number of
+// threads in batches, the standard error being that of the mean of the
+// chunks. After each batch the standard error is checked, and the next
+// batch is made as large as the standard error of the chunks so far says
+// is still needed (at least one chunk per thread, at most as many as
+// have been played). The results only depend on the seed, and the number
+// of threads. With a shoe bank each chunk plays its own range of its
+// shoes, so the most rounds are cut to what the bank holds, and the
+// simulation stops early if the next batch would need more shoes than
+// that instead of playing the same shoes again.
+void play_to_precision(const vector<string> & files, const double & target,
+                       const int & chunk_rounds, int threads, long long most_rounds,
+                       ShoeBank * bank=nullptr, unsigned seed=rand()){
+    threads=max(1,threads);
+    long long bank_chunks=(bank!=nullptr) ? bank->size()/chunk_rounds : 0;
+    if(bank!=nullptr)
+        most_rounds=min(most_rounds,bank_chunks*chunk_rounds);
+    vector<vector<int>> chroms;
+    for(const string & file : files)
+        chroms.push_back(read_strategy(file));
+    auto start=chrono::steady_clock::now();
+    RunningStats stats;
+    // At least this many chunks, for the standard deviation of the chunks
+    // to be known well enough.
+    const int least_chunks=2*max(10,threads);
+    int batch=least_chunks;
+    int chunks=0;
+    while(true){
+        if(bank!=nullptr&&chunks+batch>bank_chunks){
+            cerr << "The next " << batch << " chunks would need "
+                 << (long long) (chunks+batch)*chunk_rounds << " shoes, the shoe bank has only "
+                 << bank->size() << endl;
+            break;
+        }
+        vector<double> results(batch);
+        atomic<int> next(0);
+        vector<thread> pool;
+        for(int t=0;t<threads;++t){
+            pool.push_back(thread([&]{
+                for(int k=next++;k<batch;k=next++)
+                    results[k]=play_chunk(chroms,chunk_rounds,chunks+k,seed,bank);
+            }));
+        }
+        for(thread & t : pool)
+            t.join();
+        for(double x : results)
+            stats.add(x);
+        chunks+=batch;
+        double error=stats.get_standard_error();
+        cout << "After " << (long long) chunks*chunk_rounds << " rounds: mean "
+             << stats.get_mean() << ", standard error " << error << endl;
+        if(error<=target||(long long) chunks*chunk_rounds>=most_rounds)
+            break;
+        // Chunks needed for the target at the standard deviation so far.
+        double needed=stats.get_variance()/(target*target)-chunks;
+        batch=(int) min((double) chunks,max((double) threads,ceil(needed)));
+        batch=(int) min((long long) batch,max(1LL,most_rounds/chunk_rounds-chunks));
     }
-    myfile5 << prob_double_down_loss[vsize-1];
+    if(chunks==0)
+        return;
+    double seconds=chrono::duration<double>(chrono::steady_clock::now()-start).count();
+    double error=stats.get_standard_error();
+    cout << ((files.size()==1) ? "Edge of " : "Difference of the mean net results of ")
+         << files[0] << ((files.size()==1) ? "" : " minus "+files.back()) << ": "
+         << stats.get_mean() << " bets per round, standard error " << error
+         << ", 95% confidence interval " << stats.get_mean()-1.96*error << " to "
+         << stats.get_mean()+1.96*error << endl;
+    cout << "Target standard error " << target << (error<=target ? " met" : " not met")
+         << " with " << (long long) chunks*chunk_rounds << " rounds in " << chunks
+         << " chunks, " << seconds << " seconds" << endl;
+}
 
-    filename="prob_split.csv";
-    ofstream myfile6(filename);
-    vsize = prob_split.size()-1;
-    for(int n=0; n<vsize; n++){
-        myfile6 << prob_split[n];
-        myfile6 << "," ;
+// Results of a game of calculate_edge_and_bankroll(), in the order of the
+// columns of the game results file, each also written to the CSV file of
+// its name, with the range of its histogram.
+const int GAME_COLUMNS=10;
+const string game_columns[GAME_COLUMNS]={"edges","tot_wins","tot_losses","player_bankrolls",
+    "prob_double_down","prob_double_down_won","prob_double_down_loss",
+    "prob_split","prob_split_won","prob_split_loss"};
+const double game_column_ranges[GAME_COLUMNS][2]={{-0.15,0.15},{0,1},{0,1},{0,3000},
+    {0,1},{0,1},{0,1},{0,1},{0,1},{0,1}};
+
+// Game results file (.bjg), in the native (little-endian) byte order: a
+// 16 byte header of uint32 magic 0x52474a42 ("BJGR"), uint32 version 1,
+// uint64 number of games, then the columns back to back, each a double
+// per game in the order of the games.
+const unsigned GAME_RESULTS_MAGIC=0x52474a42;
+const unsigned GAME_RESULTS_VERSION=1;
+
+struct GameResultsHeader{
+    unsigned magic;
+    unsigned version;
+    unsigned long long games;
+};
+
+// Statistics of the games of a block, kept by the thread which plays the
+// block.
+struct GameBlock{
+    int first;
+    vector<array<double,GAME_COLUMNS>> results;
+    RunningStats stats[GAME_COLUMNS];
+    Histogram histograms[GAME_COLUMNS];
+    BankrollRecorder recorder;
+    GameBlock(const int & f, const int & rounds) : recorder("",rounds,100,rounds/500){
+        first=f;
+        for(int c=0;c<GAME_COLUMNS;++c)
+            histograms[c]=Histogram(game_column_ranges[c][0],game_column_ranges[c][1],50);
     }
-    myfile6 << prob_split[vsize-1];
+};
 
-    filename="prob_split_won.csv";
-    ofstream myfile7(filename);
-    vsize = prob_split_won.size()-1;
-    for(int n=0; n<vsize; n++){
-        myfile7 << prob_split_won[n];
-        myfile7 << "," ;
+// Play the given game round by round, recording its bankroll, and return
+// its results.
+array<double,GAME_COLUMNS> play_counting_game(CountingGame & game1, const int & game_rounds,
+                                              BankrollRecorder & recorder){
+    recorder.start_game(game1.get_player_bankroll());
+    for(int r=1;r<=game_rounds;++r){
+        game1.play(r,30,51);
+        if(game1.get_rounds_played()<r)
+            break;
+        recorder.record(r,game1.get_player_bankroll());
     }
-    myfile7 << prob_split_won[vsize-1];
+    recorder.end_game();
 
-    filename="prob_split_loss.csv";
-    ofstream myfile8(filename);
-    vsize = prob_split_loss.size()-1;
-    for(int n=0; n<vsize; n++){
-        myfile8 << prob_split_loss[n];
-        myfile8 << "," ;
+    double total_number_of_wins=game1.get_player_won();
+    double total_rounds_played=game1.get_rounds_played();
+    double total_number_of_draws=game1.get_draws();
+    double total_rounds_losses=total_rounds_played-total_number_of_wins-total_number_of_draws;
+    double prob_win=total_number_of_wins/total_rounds_played;
+    double prob_loss=total_rounds_losses/total_rounds_played;
+    double tot_double_downs=game1.get_times_player_doubled_down();
+    double double_downs_won=game1.get_times_player_doubled_down_and_won();
+    double double_downs_lost=game1.get_times_player_doubled_down_and_lost();
+    double tot_splits=game1.get_times_player_split();
+    double split_won=game1.get_times_player_split_and_won();
+    double split_lost=game1.get_times_player_split_and_lost();
+    array<double,GAME_COLUMNS> result={prob_win-prob_loss,prob_win,prob_loss,
+        (double) game1.get_player_bankroll(),
+        tot_double_downs/total_rounds_played,double_downs_won/tot_double_downs,
+        double_downs_lost/tot_double_downs,
+        tot_splits/total_rounds_played,split_won/(2*tot_splits),split_lost/(2*tot_splits)};
+    return result;
+}
+
+// Play the given number of games on the given number of threads. If there
+// is a shoe bank, the games play its shoes instead of shuffling, each game
+// its own range of them (nothing is played if the bank is too small for
+// all the games), otherwise game 'k' is seeded by the seed of segment 'k'
+// of the given seed, so the results only depend on the seed.
+// The games are played in blocks of consecutive games, and the blocks are
+// added up in their order whichever thread played them, at most a few
+// blocks per thread waiting for the ones before them, so any number of
+// games is played in the same memory.
+// The results of each game are written to the CSV files of the columns,
+// and to the game results file if its name is not empty; the mean, the
+// standard deviation and the standard error of the mean of each column
+// are printed to console, and their histograms written to
+// game_histograms.csv, one line per column: the name, the range, the
+// counts below and above the range, then the counts of the bins. The
+// bankroll paths of the games are written to bankroll_paths.bjp,
+// downsampled to 100 rounds, and the quantiles of the bankroll every 500
+// rounds to bankroll_quantiles.csv (see BankrollPath.h).
+void calculate_edge_and_bankroll(const int & rounds, ShoeBank * bank=nullptr,
+                                 int threads=thread::hardware_concurrency(),
+                                 const string & results_file="", unsigned seed=rand()){
+    const int game_rounds=10000;
+    const int block_size=64;
+    threads=max(1,threads);
+    // A game can use a shoe a round, so each game gets a range of
+    // game_rounds+1 shoes of the bank, as a Game of PoolEvaluator gets R+1
+    // (see ThreadPool.h), and the ranges of the games must not overlap.
+    if(bank!=nullptr&&bank->size()<(unsigned long long) rounds*(game_rounds+1)){
+        cerr << rounds << " games need " << (unsigned long long) rounds*(game_rounds+1)
+             << " shoes, the shoe bank has only " << bank->size() << endl;
+        return;
+    }
+    vector<int> chrom=read_strategy("strategy_chromosome.csv");
+    
+    // Totals, and the files, to which the blocks are added in order.
+    RunningStats stats[GAME_COLUMNS];
+    Histogram histograms[GAME_COLUMNS];
+    for(int c=0;c<GAME_COLUMNS;++c)
+        histograms[c]=Histogram(game_column_ranges[c][0],game_column_ranges[c][1],50);
+    BankrollRecorder recorder("bankroll_paths.bjp",game_rounds,100,game_rounds/500);
+    vector<unique_ptr<ofstream>> csv;
+    for(int c=0;c<GAME_COLUMNS;++c)
+        csv.push_back(unique_ptr<ofstream>(new ofstream(game_columns[c]+".csv")));
+    ofstream results;
+    if(!results_file.empty()){
+        results.open(results_file,ios::binary);
+        GameResultsHeader h={GAME_RESULTS_MAGIC,GAME_RESULTS_VERSION,(unsigned long long) rounds};
+        results.write((const char *) &h,sizeof(h));
+    }
+    auto add_block=[&](GameBlock & block){
+        for(int c=0;c<GAME_COLUMNS;++c){
+            stats[c].merge(block.stats[c]);
+            histograms[c].merge(block.histograms[c]);
+            for(int k=0;k<block.results.size();++k){
+                if(block.first+k>0)
+                    *csv[c] << ",";
+                *csv[c] << block.results[k][c];
+            }
+            if(results.is_open()){
+                results.seekp(sizeof(GameResultsHeader)
+                              +((unsigned long long) c*rounds+block.first)*sizeof(double));
+                for(int k=0;k<block.results.size();++k)
+                    results.write((const char *) &block.results[k][c],sizeof(double));
+            }
+        }
+        recorder.append(block.recorder);
+    };
+    
+    // Blocks played and not added yet, by their first game.
+    int blocks=(rounds+block_size-1)/block_size;
+    map<int,unique_ptr<GameBlock>> done;
+    int next_block=0;
+    int next_added=0;
+    // Whether a thread is adding blocks; the others leave theirs to it.
+    bool adding=false;
+    mutex m;
+    condition_variable cv;
+    auto play_blocks=[&]{
+        while(true){
+            int b;
+            {
+                unique_lock<mutex> lock(m);
+                // Wait while too many blocks are waiting to be added.
+                cv.wait(lock,[&]{
+                    return next_block>=blocks||next_block<next_added+2*threads;
+                });
+                if(next_block>=blocks)
+                    return;
+                b=next_block++;
+            }
+            unique_ptr<GameBlock> block(new GameBlock(b*block_size,game_rounds));
+            for(int g=block->first;g<min(rounds,block->first+block_size);++g){
+                CountingGame game1(1000,2000,2,chrom);
+                if(bank!=nullptr){
+                    unsigned long long count=game_rounds+1;
+                    game1.use_bank(bank->shoes((unsigned long long) g*count,count),bank->cards(),count);
+                }
+                else
+                    game1.seed(segment_seed(seed,g));
+                array<double,GAME_COLUMNS> result=play_counting_game(game1,game_rounds,
+                                                                     block->recorder);
+                for(int c=0;c<GAME_COLUMNS;++c){
+                    block->stats[c].add(result[c]);
+                    block->histograms[c].add(result[c]);
+                }
+                block->results.push_back(result);
+            }
+            unique_lock<mutex> lock(m);
+            done[b]=move(block);
+            if(adding)
+                continue;
+            // Take the blocks which are next in order and write them out
+            // without the lock, so that the others keep playing meanwhile.
+            adding=true;
+            while(done.count(next_added)){
+                vector<unique_ptr<GameBlock>> ready;
+                for(int k=next_added;done.count(k);++k){
+                    ready.push_back(move(done[k]));
+                    done.erase(k);
+                }
+                lock.unlock();
+                for(unique_ptr<GameBlock> & r : ready)
+                    add_block(*r);
+                lock.lock();
+                next_added+=ready.size();
+                cv.notify_all();
+            }
+            adding=false;
+        }
+    };
+    vector<thread> pool;
+    for(int t=0;t<threads;++t)
+        pool.push_back(thread(play_blocks));
+    for(thread & t : pool)
+        t.join();
+    
+    recorder.get_quantiles().write("bankroll_quantiles.csv",{0.05,0.25,0.5,0.75,0.95});
+    ofstream hist("game_histograms.csv");
+    for(int c=0;c<GAME_COLUMNS;++c){
+        cout << game_columns[c] << ": mean " << stats[c].get_mean()
+             << ", standard deviation " << sqrt(stats[c].get_variance())
+             << ", standard error " << stats[c].get_standard_error()
+             << " over " << stats[c].get_count() << " games" << endl;
+        hist << game_columns[c] << "," << histograms[c].get_lowest() << ","
+             << histograms[c].get_highest() << "," << histograms[c].get_below() << ","
+             << histograms[c].get_above();
+        for(long long n : histograms[c].get_counts())
+            hist << "," << n;
+        hist << endl;
     }
-    myfile8 << prob_split_loss[vsize-1];
 }
 
 int main(){
     srand(100000000*time(NULL));
     Game game1(1000,2000,2);
     
-    // Sample game
-    play_game(game1);
+    // Shoe bank (see ShoeBank.h, made by make_shoe_bank.cpp in the
+    // Evolve_strategy module) which the games play instead of shuffled
+    // decks, so that the results of different runs are for the same cards.
+    // Empty for none.
+    string shoe_bank_file="";
+    unique_ptr<ShoeBank> bank;
+    if(!shoe_bank_file.empty()){
+        bank.reset(new ShoeBank(shoe_bank_file));
+        if(!bank->valid())
+            return 1;
+    }
+    
+    // If not empty, the strategies of these files are played against the
+    // one of strategy_chromosome.csv on the same rounds (see below).
+    vector<string> head_to_head_files={};
+    
+    // If above zero, the edge of strategy_chromosome.csv (or, with the
+    // head to head files above, the difference of the first of them and
+    // strategy_chromosome.csv) is
+    // simulated until its standard error is at most this many bets per
+    // round, instead of the games below.
+    double target_standard_error=0;
+    if(target_standard_error>0){
+        vector<string> files={"strategy_chromosome.csv"};
+        if(!head_to_head_files.empty())
+            files.push_back(head_to_head_files[0]);
+        play_to_precision(files,target_standard_error,10000,thread::hardware_concurrency(),
+                          10000000000LL,bank.get());
+        return 0;
+    }
+    
+    // Otherwise the strategies of the head to head files are played head
+    // to head against the one of strategy_chromosome.csv on the same
+    // rounds, instead of the games below.
+    if(!head_to_head_files.empty()){
+        vector<string> files={"strategy_chromosome.csv"};
+        files.insert(files.end(),head_to_head_files.begin(),head_to_head_files.end());
+        play_head_to_head(files,10000000,bank.get());
+        return 0;
+    }
+    
+    // Sample game. If segments is more than one, its rounds are split into
+    // that many segments played on separate threads (on shuffled decks).
+    int segments=1;
+    if(segments>1)
+        play_segmented_game(1000,2000,2,10000,segments);
+    else{
+        if(bank){
+            unsigned long long count=10001;
+            game1.use_bank(bank->shoes(0,count),bank->cards(),count);
+        }
+        play_game(game1);
+    }
     
-    // Play 1000 games/rounds. Each game will be 10000 rounds.
+    // Play 1000 games/rounds. Each game will be 10000 rounds. The games
+    // are played on one thread per core, and their results also written
+    // to the game results file if its name is not empty (such as
+    // "game_results.bjg").
     int rounds1=1000;
-    calculate_edge_and_bankroll(rounds1);
+    int threads=thread::hardware_concurrency();
+    string game_results_file="";
+    calculate_edge_and_bankroll(rounds1,bank.get(),threads,game_results_file);
     
     return 0;
 }